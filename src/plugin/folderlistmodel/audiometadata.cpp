@@ -0,0 +1,301 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: audiometadata.cpp
+ * Date: 17/10/2026
+ */
+
+#include "audiometadata.h"
+
+#include <taglib/id3v2tag.h>
+#include <taglib/fileref.h>
+#include <taglib/mpegfile.h>
+#include <taglib/tag.h>
+#include <taglib/audioproperties.h>
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QDebug>
+
+Q_GLOBAL_STATIC(AudioMetaDataCache, audioMetaDataCache)
+
+namespace {
+const quint32 audioMetaDataMagic = 0x464d414d;  // "FMAM"
+
+inline QString toQString(const TagLib::String &str)
+{
+    return QString::fromUtf8(str.toCString(true));
+}
+}
+
+
+AudioMetaDataCache::AudioMetaDataCache(int maxEntries)
+    : m_records(maxEntries)
+    , m_fileName(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                 + QLatin1String("/audiometadata.cache"))
+    , m_loaded(false)
+    , m_dirty(false)
+{
+    m_lastSave.start();
+}
+
+AudioMetaDataCache::~AudioMetaDataCache()
+{
+    save(true);
+}
+
+AudioMetaDataCache *AudioMetaDataCache::instance()
+{
+    return audioMetaDataCache();
+}
+
+/*!
+ * \brief AudioMetaDataCache::find()
+ * \return true when \a path has a record taken when the file had \a size and \a lastModified
+ */
+bool AudioMetaDataCache::find(const QString &path, qint64 size,
+                              const QDateTime &lastModified, AudioMetaData &data)
+{
+    QMutexLocker lock(&m_mutex);
+    const AudioMetaData *record = m_records.object(path);
+    if (record == 0 || record->size != size || record->lastModified != lastModified) {
+        return false;
+    }
+    data = *record;
+    return true;
+}
+
+void AudioMetaDataCache::insert(const AudioMetaData &data)
+{
+    QMutexLocker lock(&m_mutex);
+    m_records.insert(data.path, new AudioMetaData(data));
+    m_dirty = true;
+}
+
+void AudioMetaDataCache::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_records.clear();
+    m_dirty = true;
+}
+
+/*!
+ * \brief AudioMetaDataCache::load() reads the saved records once, it reads the disk
+ *
+ *  Records already in memory are newer than the saved ones and are kept
+ */
+void AudioMetaDataCache::load()
+{
+    QMutexLocker fileLock(&m_fileMutex);
+    {
+        QMutexLocker lock(&m_mutex);
+        if (m_loaded) {
+            return;
+        }
+        m_loaded = true;
+    }
+    readFile();
+}
+
+void AudioMetaDataCache::readFile()
+{
+    QFile file(fileName());
+    if (!file.open(QFile::ReadOnly)) {
+        return;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic   = 0;
+    qint32  version = 0;
+    qint32  count   = 0;
+    stream >> magic >> version >> count;
+    if (magic != audioMetaDataMagic || version != AUDIO_METADATA_CACHE_VERSION || count < 0) {
+        return;
+    }
+
+    AudioMetaDataList records;
+    records.reserve(qMin(count, AUDIO_METADATA_CACHE_MAX_ENTRIES));
+    for (qint32 counter = 0; counter < count && stream.status() == QDataStream::Ok; ++counter) {
+        AudioMetaData data;
+        qint64 modified = 0;
+        stream >> data.path >> data.size >> modified
+               >> data.title >> data.artist >> data.album >> data.genre
+               >> data.year >> data.track >> data.length >> data.hasCover;
+        data.lastModified = QDateTime::fromMSecsSinceEpoch(modified);
+        records.append(data);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << Q_FUNC_INFO << "ignoring damaged file" << file.fileName();
+        return;
+    }
+
+    QMutexLocker lock(&m_mutex);
+    foreach (const AudioMetaData &data, records) {
+        if (!m_records.contains(data.path)) {
+            m_records.insert(data.path, new AudioMetaData(data));
+        }
+    }
+
+#if DEBUG_MESSAGES
+    qDebug() << Q_FUNC_INFO << "loaded" << records.count() << "records from" << file.fileName();
+#endif
+}
+
+/*!
+ * \brief AudioMetaDataCache::save() writes the records when they changed, it reads the disk
+ * \param force when false the file is written at most once every \ref AUDIO_METADATA_SAVE_INTERVAL
+ */
+void AudioMetaDataCache::save(bool force)
+{
+    QMutexLocker fileLock(&m_fileMutex);
+    bool needsLoad = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (!m_dirty || m_fileName.isEmpty()
+                || (!force && m_lastSave.elapsed() < AUDIO_METADATA_SAVE_INTERVAL)) {
+            return;
+        }
+        needsLoad = !m_loaded;
+        m_loaded  = true;
+    }
+    // saved records not loaded yet would be thrown away
+    if (needsLoad) {
+        readFile();
+    }
+
+    AudioMetaDataList records;
+    {
+        QMutexLocker lock(&m_mutex);
+        const QList<QString> paths = m_records.keys();
+        records.reserve(paths.count());
+        foreach (const QString &path, paths) {
+            records.append(*m_records.object(path));
+        }
+        m_dirty = false;
+        m_lastSave.restart();
+    }
+    if (!writeFile(records)) {
+        qWarning() << Q_FUNC_INFO << "could not save" << fileName();
+    }
+}
+
+bool AudioMetaDataCache::writeFile(const AudioMetaDataList &records)
+{
+    const QString name = fileName();
+    QDir().mkpath(QFileInfo(name).absolutePath());
+    QSaveFile file(name);
+    if (!file.open(QFile::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << audioMetaDataMagic << qint32(AUDIO_METADATA_CACHE_VERSION) << qint32(records.count());
+    foreach (const AudioMetaData &data, records) {
+        stream << data.path << data.size << data.lastModified.toMSecsSinceEpoch()
+               << data.title << data.artist << data.album << data.genre
+               << data.year << data.track << data.length << data.hasCover;
+    }
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+/*!
+ * \brief AudioMetaDataCache::setFileName() sets where records are saved, an empty \a fileName disables it
+ */
+void AudioMetaDataCache::setFileName(const QString &fileName)
+{
+    QMutexLocker lock(&m_mutex);
+    m_fileName = fileName;
+    m_loaded   = false;
+}
+
+QString AudioMetaDataCache::fileName() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_fileName;
+}
+
+
+AudioMetaDataExtractor::AudioMetaDataExtractor(const DirItemInfoList &files)
+    : IORequest()
+    , m_files(files)
+{
+    m_type     = AudioMetaDataRead;
+    // below the listing of the current directory, the tags are useless without it
+    m_priority = ExternalChangesPriority;
+}
+
+void AudioMetaDataExtractor::run()
+{
+    AudioMetaDataCache *cache = AudioMetaDataCache::instance();
+    cache->load();
+
+    AudioMetaDataList records;
+    records.reserve(m_files.count());
+    foreach (const DirItemInfo &file, m_files) {
+        if (isCancelled()) {
+            break;
+        }
+        AudioMetaData data;
+        if (!cache->find(file.absoluteFilePath(), file.size(), file.lastModified(), data)) {
+            data = parse(file);
+            cache->insert(data);
+        }
+        records.append(data);
+    }
+
+    if (!records.isEmpty()) {
+        emit extracted(records);
+    }
+    cache->save();
+}
+
+/*!
+ * \brief AudioMetaDataExtractor::parse() opens \a file once and reads all its tags
+ */
+AudioMetaData AudioMetaDataExtractor::parse(const DirItemInfo &file)
+{
+    AudioMetaData data;
+    data.path         = file.absoluteFilePath();
+    data.size         = file.size();
+    data.lastModified = file.lastModified();
+
+    TagLib::FileRef ref(QFile::encodeName(data.path).constData(), true, TagLib::AudioProperties::Fast);
+    if (ref.isNull()) {
+        return data;
+    }
+    TagLib::Tag *tag = ref.tag();
+    if (tag) {
+        data.title  = toQString(tag->title());
+        data.artist = toQString(tag->artist());
+        data.album  = toQString(tag->album());
+        data.genre  = toQString(tag->genre());
+        data.year   = static_cast<int> (tag->year());
+        data.track  = static_cast<int> (tag->track());
+    }
+    if (ref.audioProperties()) {
+        data.length = ref.audioProperties()->length();
+    }
+    TagLib::MPEG::File *mp3 = dynamic_cast<TagLib::MPEG::File *> (ref.file());
+    if (mp3 && mp3->ID3v2Tag()) {
+        data.hasCover = !mp3->ID3v2Tag()->frameListMap()["APIC"].isEmpty();
+    }
+    return data;
+}
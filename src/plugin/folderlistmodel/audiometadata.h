@@ -0,0 +1,137 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: audiometadata.h
+ * Date: 17/10/2026
+ */
+
+#ifndef AUDIOMETADATA_H
+#define AUDIOMETADATA_H
+
+#include "iorequest.h"
+
+#include <QCache>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+/*!
+ *  Maximum number of files \ref AudioMetaDataCache keeps
+ */
+#define AUDIO_METADATA_CACHE_MAX_ENTRIES   16384
+
+/*!
+ *  Format version of the file saved by \ref AudioMetaDataCache, files with other versions are ignored
+ */
+#define AUDIO_METADATA_CACHE_VERSION       2
+
+/*!
+ *  Minimum time between two saves of the \ref AudioMetaDataCache file
+ */
+#define AUDIO_METADATA_SAVE_INTERVAL       (30 * 1000)   // ms
+
+/*!
+ * \brief The AudioMetaData struct has the tags of an audio file needed by the Track roles of \ref DirModel
+ *
+ *  \a path, \a size and \a lastModified identify the file version the tags were read from,
+ *  files without tags also get a record, so they are not parsed again.
+ */
+struct AudioMetaData
+{
+    AudioMetaData() : size(0), year(0), track(0), length(0), hasCover(false) {}
+
+    QString   path;
+    qint64    size;
+    QDateTime lastModified;
+    QString   title;
+    QString   artist;
+    QString   album;
+    QString   genre;
+    int       year;
+    int       track;
+    int       length;     //!< seconds
+    bool      hasCover;   //!< there is an ID3v2 attached picture
+};
+
+typedef QVector<AudioMetaData> AudioMetaDataList;
+
+Q_DECLARE_METATYPE(AudioMetaDataList)
+
+
+/*!
+ * \brief The AudioMetaDataCache class keeps the \ref AudioMetaData of the files already parsed
+ *
+ *  It is shared by all \ref DirModel objects and by the \ref AudioMetaDataExtractor threads.
+ *  Records are saved in a single file in the cache directory, it is read by the first
+ *  \ref AudioMetaDataExtractor, so the GUI thread never reads it.
+ */
+class AudioMetaDataCache
+{
+public:
+    explicit AudioMetaDataCache(int maxEntries = AUDIO_METADATA_CACHE_MAX_ENTRIES);
+    ~AudioMetaDataCache();
+
+    static AudioMetaDataCache *instance();
+
+    bool      find(const QString &path, qint64 size, const QDateTime &lastModified, AudioMetaData &data);
+    void      insert(const AudioMetaData &data);
+    void      clear();
+
+    void      load();
+    void      save(bool force = false);
+    void      setFileName(const QString &fileName);
+    QString   fileName() const;
+
+private:
+    void      readFile();
+    bool      writeFile(const AudioMetaDataList &records);
+
+private:
+    mutable QMutex               m_mutex;
+    QMutex                       m_fileMutex;   //!< serializes \ref load() and \ref save()
+    QCache<QString, AudioMetaData> m_records;
+    QString                      m_fileName;
+    bool                         m_loaded;
+    bool                         m_dirty;
+    QElapsedTimer                m_lastSave;
+};
+
+
+/*!
+ * \brief The AudioMetaDataExtractor class reads the tags of local audio files in an IO thread
+ *
+ *  Each file is parsed once with TagLib::FileRef, records already in
+ *  \ref AudioMetaDataCache are not parsed again.
+ */
+class AudioMetaDataExtractor : public IORequest
+{
+    Q_OBJECT
+public:
+    explicit AudioMetaDataExtractor(const DirItemInfoList &files);
+    void run();
+
+    static AudioMetaData parse(const DirItemInfo &file);
+
+signals:
+    void extracted(const AudioMetaDataList &records);
+
+private:
+    DirItemInfoList  m_files;
+};
+
+#endif // AUDIOMETADATA_H
@@ -0,0 +1,111 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: dirchildcounter.cpp
+ * Date: 17/10/2026
+ */
+
+#include "dirchildcounter.h"
+
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QDebug>
+
+Q_GLOBAL_STATIC(DirChildCountCache, dirChildCountCache)
+
+
+DirChildCountCache::DirChildCountCache(int maxEntries)
+    : m_counts(maxEntries)
+{
+}
+
+DirChildCountCache *DirChildCountCache::instance()
+{
+    return dirChildCountCache();
+}
+
+QString DirChildCountCache::makeKey(const QString &path, QDir::Filters filter)
+{
+    return QString::number(static_cast<int> (filter)) + QLatin1Char(':') + path;
+}
+
+/*!
+ * \brief DirChildCountCache::find()
+ * \param count receives the number of items of \a path
+ * \return true when \a path was counted with \a filter and its modification time was \a dirModified
+ */
+bool DirChildCountCache::find(const QString &path, QDir::Filters filter,
+                              const QDateTime &dirModified, int &count)
+{
+    const Entry *entry = m_counts.object(makeKey(path, filter));
+    if (entry == 0 || entry->dirModified != dirModified) {
+        return false;
+    }
+    count = entry->count;
+    return true;
+}
+
+void DirChildCountCache::insert(const QDir::Filters filter, const DirChildCount &childCount)
+{
+    Entry *entry       = new Entry;
+    entry->dirModified = childCount.dirModified;
+    entry->count       = childCount.count;
+    m_counts.insert(makeKey(childCount.path, filter), entry);
+}
+
+void DirChildCountCache::clear()
+{
+    m_counts.clear();
+}
+
+
+DirChildCounter::DirChildCounter(const QStringList &paths, QDir::Filters filter)
+    : IORequest()
+    , m_paths(paths)
+    , m_filter(filter)
+{
+    m_type     = ChildCount;
+    // below the listing of the current directory, the counts are useless without it
+    m_priority = ExternalChangesPriority;
+}
+
+void DirChildCounter::run()
+{
+    DirChildCountList counts;
+    counts.reserve(m_paths.count());
+    foreach (const QString &path, m_paths) {
+        if (isCancelled()) {
+            return;
+        }
+        DirChildCount childCount;
+        childCount.path        = path;
+        // taken before reading, so a change while counting makes the next lookup miss
+        childCount.dirModified = QFileInfo(path).lastModified();
+        childCount.count       = 0;
+        QDirIterator it(path, m_filter);
+        while (it.hasNext()) {
+            it.next();
+            ++childCount.count;
+        }
+        counts.append(childCount);
+    }
+
+#if DEBUG_MESSAGES
+    qDebug() << Q_FUNC_INFO << "counted" << counts.count() << "directories";
+#endif
+
+    emit countsReady(counts);
+}
@@ -0,0 +1,103 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: dirchildcounter.h
+ * Date: 17/10/2026
+ */
+
+#ifndef DIRCHILDCOUNTER_H
+#define DIRCHILDCOUNTER_H
+
+#include "iorequest.h"
+
+#include <QCache>
+#include <QDateTime>
+#include <QDir>
+#include <QStringList>
+#include <QVector>
+
+/*!
+ *  Maximum number of directories \ref DirChildCountCache keeps
+ */
+#define DIR_CHILD_COUNT_CACHE_MAX_ENTRIES   4096
+
+/*!
+ * \brief The DirChildCount struct is the number of items of a directory when it had \a dirModified
+ */
+struct DirChildCount
+{
+    QString   path;
+    QDateTime dirModified;
+    int       count;
+};
+
+typedef QVector<DirChildCount> DirChildCountList;
+
+Q_DECLARE_METATYPE(DirChildCountList)
+
+
+/*!
+ * \brief The DirChildCountCache class keeps the number of items of local directories
+ *
+ *  It is shared by all \ref DirModel objects and only used from the GUI thread.
+ *  A count is valid while the directory keeps the modification time it had when it was counted,
+ *  the filter is part of the key because hidden files may be shown or not.
+ */
+class DirChildCountCache
+{
+public:
+    explicit DirChildCountCache(int maxEntries = DIR_CHILD_COUNT_CACHE_MAX_ENTRIES);
+
+    static DirChildCountCache *instance();
+
+    bool      find(const QString &path, QDir::Filters filter, const QDateTime &dirModified, int &count);
+    void      insert(const QDir::Filters filter, const DirChildCount &childCount);
+    void      clear();
+
+private:
+    static QString makeKey(const QString &path, QDir::Filters filter);
+
+private:
+    struct Entry {
+        QDateTime dirModified;
+        int       count;
+    };
+    QCache<QString, Entry>  m_counts;
+};
+
+
+/*!
+ * \brief The DirChildCounter class counts the items of a list of local directories in an IO thread
+ *
+ *  \ref DirModel uses it for the \ref DirModel::FileSizeRole of directories,
+ *  the counts are sent by \ref countsReady() all together when the request finishes.
+ */
+class DirChildCounter : public IORequest
+{
+    Q_OBJECT
+public:
+    DirChildCounter(const QStringList &paths, QDir::Filters filter);
+    void run();
+
+signals:
+    void countsReady(const DirChildCountList &counts);
+
+private:
+    QStringList    m_paths;
+    QDir::Filters  m_filter;
+};
+
+#endif // DIRCHILDCOUNTER_H
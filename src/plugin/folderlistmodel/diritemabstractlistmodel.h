@@ -37,6 +37,7 @@ class DirItemAbstractListModel : public QAbstractListModel
 public:
     virtual int getIndex(const QString &name) = 0;
     virtual void notifyItemChanged(int index) = 0;
+    virtual void notifyItemsChanged(int first, int last) = 0;
 
 protected:
     explicit DirItemAbstractListModel(QObject *parent = 0) :
@@ -23,16 +23,77 @@
 #include "locationurl.h"
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <QFile>
+#include <QCollator>
+#include <QThreadStorage>
+#include <QAtomicInt>
+#include <QReadWriteLock>
+#include <QHash>
+
+#include <limits>
+
+namespace {
+QAtomicInt sortKeyGeneration(0);   //!< changes when \ref DirItemInfo::setNumericSortKeys() changes the mode
+QAtomicInt sortKeyNumeric(0);
+QAtomicInt mimePolicy(DirItemInfo::MimeTypeFromExtensionThenContent);
+
+struct ThreadCollator {
+    QCollator collator;
+    int       generation;
+};
+// QCollator is not thread safe, keys are created in the IO threads as well
+QThreadStorage<ThreadCollator *> threadCollators;
+// last parent path used in each thread, see DirItemInfoPrivate::sharedPath()
+QThreadStorage<QString *> threadSharedPaths;
+
+const QCollator &currentCollator(int generation)
+{
+    ThreadCollator *data = threadCollators.localData();
+    if (data == 0) {
+        data = new ThreadCollator;
+        data->generation = generation - 1;
+        threadCollators.setLocalData(data);
+    }
+    if (data->generation != generation) {
+        data->collator.setNumericMode(sortKeyNumeric.load() != 0);
+        data->generation = generation;
+    }
+    return data->collator;
+}
+
+inline qint64 msecsOf(const struct timespec &time)
+{
+    return static_cast<qint64> (time.tv_sec) * 1000 + time.tv_nsec / 1000000;
+}
+
+/*!
+ * \brief The MimeTypeTable struct keeps each mime type found once, items keep their index
+ *
+ *  QMimeDatabase creates a new QMimeType for every lookup, a listing would hold as many copies
+ *  of the same type as files.
+ */
+struct MimeTypeTable {
+    QReadWriteLock          lock;
+    QVector<QMimeType>      types;
+    QHash<QString, quint16> indexes;
+};
+Q_GLOBAL_STATIC(MimeTypeTable, mimeTypeTable)
+}
 
 
 QMimeDatabase DirItemInfoPrivate::mimeDatabase;
+const qint64  DirItemInfoPrivate::InvalidTime = std::numeric_limits<qint64>::min();
+const quint32 DirItemInfoPrivate::UnknownId   = quint32(-2);
+const quint16 DirItemInfoPrivate::NoMimeType  = 0xffff;
 
 
 DirItemInfoPrivate::DirItemInfoPrivate() :
     _isValid(false)
     , _isLocal(false)
     , _isRemote(false)
-    , _isSelected(false)
     , _isAbsolute(false)
     , _exists(false)
     , _isFile(false)
@@ -47,8 +108,16 @@ DirItemInfoPrivate::DirItemInfoPrivate() :
     , _isWorkGroup(false)
     , _isNetworkShare(false)
     , _needsAuthentication(false)
+    , _needsStat(false)
+    , _mimeTypeState(MimeTypeUnresolved)
     , _permissions(0)
+    , _mimeTypeIndex(NoMimeType)
+    , _ownerId(UnknownId)
+    , _groupId(UnknownId)
     , _size(0)
+    , _created(InvalidTime)
+    , _lastModified(InvalidTime)
+    , _lastRead(InvalidTime)
 {
 
 }
@@ -59,7 +128,6 @@ DirItemInfoPrivate::DirItemInfoPrivate(const DirItemInfoPrivate &other):
     , _isValid(other._isValid)
     , _isLocal(other._isLocal)
     , _isRemote(other._isRemote)
-    , _isSelected(other._isSelected)
     , _isAbsolute(other._isAbsolute)
     , _exists(other._exists)
     , _isFile(other._isFile)
@@ -74,7 +142,12 @@ DirItemInfoPrivate::DirItemInfoPrivate(const DirItemInfoPrivate &other):
     , _isWorkGroup(other._isWorkGroup)
     , _isNetworkShare(other._isNetworkShare)
     , _needsAuthentication(other._needsAuthentication)
+    , _needsStat(other._needsStat)
+    , _mimeTypeState(other._mimeTypeState)
     , _permissions(other._permissions)
+    , _mimeTypeIndex(other._mimeTypeIndex)
+    , _ownerId(other._ownerId)
+    , _groupId(other._groupId)
     , _size(other._size)
     , _created(other._created)
     , _lastModified(other._lastModified)
@@ -92,7 +165,6 @@ DirItemInfoPrivate::DirItemInfoPrivate(const QFileInfo &fi):
     _isValid(true)
     , _isLocal(true)
     , _isRemote(false)
-    , _isSelected(false)
     , _isAbsolute(false)
     , _exists(false)
     , _isFile(false)
@@ -107,8 +179,16 @@ DirItemInfoPrivate::DirItemInfoPrivate(const QFileInfo &fi):
     , _isWorkGroup(false)
     , _isNetworkShare(false)
     , _needsAuthentication(false)
+    , _needsStat(false)
+    , _mimeTypeState(MimeTypeUnresolved)
     , _permissions(0)
+    , _mimeTypeIndex(NoMimeType)
+    , _ownerId(UnknownId)
+    , _groupId(UnknownId)
     , _size(0)
+    , _created(InvalidTime)
+    , _lastModified(InvalidTime)
+    , _lastRead(InvalidTime)
 {
     setFileInfo(fi);
 }
@@ -119,7 +199,7 @@ void DirItemInfoPrivate::setFileInfo(const QFileInfo &fi)
         QFileInfo abs(fi.absoluteFilePath());
         setFileInfo(abs);
     } else {
-        _path           = fi.absolutePath();
+        _path           = sharedPath(fi.absolutePath());
         _normalizedPath = _path;
         _fileName       = fi.fileName();
         _isAbsolute     = fi.isAbsolute();
@@ -131,14 +211,123 @@ void DirItemInfoPrivate::setFileInfo(const QFileInfo &fi)
         _isReadable     = fi.isReadable();
         _isWritable     = fi.isWritable();
         _isExecutable   = fi.isExecutable();
-        _permissions    = fi.permissions();
+        _permissions    = static_cast<quint16> (fi.permissions());
+        _ownerId        = fi.ownerId();
+        _groupId        = fi.groupId();
         _size           = fi.size();
-        _created        = fi.created();
-        _lastRead       = fi.lastRead();
-        _lastModified   = fi.lastModified();
+        _created        = toMSecs(fi.created());
+        _lastRead       = toMSecs(fi.lastRead());
+        _lastModified   = toMSecs(fi.lastModified());
+        _needsStat      = false;
+        _mimeTypeState  = MimeTypeUnresolved;
     }
 }
 
+/*!
+ * \brief DirItemInfoPrivate::mimeTypeFromName() finds the mime type using only the name, nothing is stored
+ *
+ *  Depending on \ref DirItemInfo::mimeTypePolicy() the content of local files may still
+ *  have to be read later by \ref DirItemInfo::resolveMimeTypeFromContent(), \a state tells that.
+ */
+QMimeType DirItemInfoPrivate::mimeTypeFromName(MimeTypeState *state) const
+{
+    if (_isDir) {
+        *state = MimeTypeResolved;
+        return mimeDatabase.mimeTypeForName(QLatin1String("inode/directory"));
+    }
+    const QMimeType mime = mimeDatabase.mimeTypeForFile(_fileName, QMimeDatabase::MatchExtension);
+
+    const DirItemInfo::MimeTypePolicy policy = DirItemInfo::mimeTypePolicy();
+    const bool readContent = _isLocal && _isFile &&
+                             (policy == DirItemInfo::MimeTypeFromContent ||
+                              (policy == DirItemInfo::MimeTypeFromExtensionThenContent && mime.isDefault()));
+    *state = readContent ? MimeTypeNeedsContent : MimeTypeResolved;
+    return mime;
+}
+
+/*!
+ * \brief DirItemInfoPrivate::resolveMimeTypeFromName() stores the result of \ref mimeTypeFromName()
+ */
+void DirItemInfoPrivate::resolveMimeTypeFromName()
+{
+    MimeTypeState state;
+    _mimeTypeIndex = mimeTypeIndex(mimeTypeFromName(&state));
+    _mimeTypeState = state;
+}
+
+/*!
+ * \brief DirItemInfoPrivate::mimeTypeIndex() returns the index of \a mime in the table shared by all items
+ *
+ *  \return \ref NoMimeType for an invalid type
+ */
+quint16 DirItemInfoPrivate::mimeTypeIndex(const QMimeType &mime)
+{
+    if (!mime.isValid()) {
+        return NoMimeType;
+    }
+    MimeTypeTable *table = mimeTypeTable();
+    const QString name = mime.name();
+    {
+        QReadLocker lock(&table->lock);
+        QHash<QString, quint16>::const_iterator found = table->indexes.constFind(name);
+        if (found != table->indexes.constEnd()) {
+            return found.value();
+        }
+    }
+    QWriteLocker lock(&table->lock);
+    QHash<QString, quint16>::const_iterator found = table->indexes.constFind(name);
+    if (found != table->indexes.constEnd()) {
+        return found.value();
+    }
+    if (table->types.count() >= NoMimeType) {
+        return NoMimeType;
+    }
+    const quint16 index = table->types.count();
+    table->types.append(mime);
+    table->indexes.insert(name, index);
+    return index;
+}
+
+/*!
+ * \brief DirItemInfoPrivate::mimeTypeAt() returns the type of \a index, an invalid type for \ref NoMimeType
+ */
+QMimeType DirItemInfoPrivate::mimeTypeAt(quint16 index)
+{
+    MimeTypeTable *table = mimeTypeTable();
+    QReadLocker lock(&table->lock);
+    return index < table->types.count() ? table->types.at(index) : QMimeType();
+}
+
+/*!
+ * \brief DirItemInfoPrivate::sharedPath() returns \a path sharing its data with the last path
+ *  used in this thread when both are equal
+ *
+ *  Items are created directory by directory, so every item of a directory ends up
+ *  holding the same copy of the parent path instead of its own.
+ */
+QString DirItemInfoPrivate::sharedPath(const QString &path)
+{
+    QString *last = threadSharedPaths.localData();
+    if (last == 0) {
+        last = new QString;
+        threadSharedPaths.setLocalData(last);
+    }
+    if (*last != path) {
+        *last = path;
+    }
+    return *last;
+}
+
+qint64 DirItemInfoPrivate::toMSecs(const QDateTime &dateTime)
+{
+    return dateTime.isValid() ? dateTime.toMSecsSinceEpoch() : InvalidTime;
+}
+
+QDateTime DirItemInfoPrivate::fromMSecs(qint64 msecs)
+{
+    return msecs == InvalidTime ? QDateTime() : QDateTime::fromMSecsSinceEpoch(msecs);
+}
+
 //================================================================
 
 DirItemInfo::DirItemInfo(): d_ptr(new DirItemInfoPrivate())
@@ -161,24 +350,6 @@ DirItemInfo::DirItemInfo(const DirItemInfo &other)
     d_ptr = other.d_ptr;
 }
 
-bool DirItemInfo::isSelected() const
-{
-    return d_ptr->_isSelected;
-}
-
-/*!
- * \brief DirItemInfo::setSelection()
- * \param selected true/false new selection state
- * \return true if a new state was set, false if the selection is already equal to \a selected
- */
-bool DirItemInfo::setSelection(bool selected)
-{
-    bool ret = selected != isSelected();
-    d_ptr->_isSelected = selected;
-
-    return ret;
-}
-
 bool DirItemInfo::isValid() const
 {
     return d_ptr->_isValid;
@@ -281,7 +452,23 @@ bool DirItemInfo::isRoot() const
 
 QFile::Permissions  DirItemInfo::permissions() const
 {
-    return d_ptr->_permissions;
+    return QFile::Permissions(QFlag(d_ptr->_permissions));
+}
+
+/*!
+ * \brief DirItemInfo::ownerId() the user id of the owner as given by stat(), uint(-2) when unknown as in QFileInfo
+ */
+uint DirItemInfo::ownerId() const
+{
+    return d_ptr->_ownerId;
+}
+
+/*!
+ * \brief DirItemInfo::groupId() the group id of the item as given by stat(), uint(-2) when unknown
+ */
+uint DirItemInfo::groupId() const
+{
+    return d_ptr->_groupId;
 }
 
 qint64 DirItemInfo::size() const
@@ -291,17 +478,28 @@ qint64 DirItemInfo::size() const
 
 QDateTime DirItemInfo::created() const
 {
-    return d_ptr->_created;
+    return DirItemInfoPrivate::fromMSecs(d_ptr->_created);
 }
 
 QDateTime DirItemInfo::lastModified() const
 {
-    return d_ptr->_lastModified;
+    return DirItemInfoPrivate::fromMSecs(d_ptr->_lastModified);
 }
 
 QDateTime DirItemInfo::lastRead() const
 {
-    return d_ptr->_lastRead;
+    return DirItemInfoPrivate::fromMSecs(d_ptr->_lastRead);
+}
+
+/*!
+ * \brief DirItemInfo::lastModifiedMSecs() is \ref lastModified() as msecs since epoch
+ *
+ *  Comparing it avoids creating QDateTime objects when sorting or comparing listings,
+ *  an unknown time is lower than any valid time.
+ */
+qint64 DirItemInfo::lastModifiedMSecs() const
+{
+    return d_ptr->_lastModified;
 }
 
 void DirItemInfo::setFile(const QString &dir, const QString &file)
@@ -329,9 +527,88 @@ QString DirItemInfo::path() const
     return d_ptr->_path;
 }
 
+/*!
+ * \brief DirItemInfo::mimeType() returns the type found by \ref resolveMimeTypeFromName() or by
+ *  \ref resolveMimeTypeFromContent(), it never reads the disk
+ *
+ *  The data may be shared with copies in other threads, so an unresolved type is found
+ *  again on every call instead of being stored here.
+ */
 QMimeType DirItemInfo::mimeType() const
 {
-    return d_ptr->mimeDatabase.mimeTypeForFile(diskFileInfo());
+    if (d_ptr->_mimeTypeState == DirItemInfoPrivate::MimeTypeUnresolved) {
+        DirItemInfoPrivate::MimeTypeState state;
+        return d_ptr->mimeTypeFromName(&state);
+    }
+    return DirItemInfoPrivate::mimeTypeAt(d_ptr->_mimeTypeIndex);
+}
+
+/*!
+ * \brief DirItemInfo::resolveMimeTypeFromName() finds the mime type using only the name
+ *
+ *  IO threads call it for every item they create and the model for items created in the GUI thread,
+ *  before the item is shared. Nothing is done when the type is already known.
+ */
+void DirItemInfo::resolveMimeTypeFromName()
+{
+    // constData() does not detach a resolved item
+    if (d_ptr.constData()->_mimeTypeState == DirItemInfoPrivate::MimeTypeUnresolved) {
+        d_ptr->resolveMimeTypeFromName();
+    }
+}
+
+/*!
+ * \brief DirItemInfo::needsMimeTypeFromContent()
+ * \return true when \ref mimeTypePolicy() says the content of this file must be read
+ *   and \ref resolveMimeTypeFromContent() was not called yet
+ */
+bool DirItemInfo::needsMimeTypeFromContent() const
+{
+    DirItemInfoPrivate::MimeTypeState state =
+            static_cast<DirItemInfoPrivate::MimeTypeState> (d_ptr->_mimeTypeState);
+    if (state == DirItemInfoPrivate::MimeTypeUnresolved) {
+        d_ptr->mimeTypeFromName(&state);
+    }
+    return state == DirItemInfoPrivate::MimeTypeNeedsContent;
+}
+
+/*!
+ * \brief DirItemInfo::resolveMimeTypeFromContent() reads the file content to find its mime type
+ *
+ *  It reads the disk, it is meant to run in an IO thread,
+ *  the type found by name is kept when the content does not give a known type.
+ */
+void DirItemInfo::resolveMimeTypeFromContent()
+{
+    resolveMimeTypeFromName();
+    if (needsMimeTypeFromContent()) {
+        QMimeType mime = d_ptr->mimeDatabase.mimeTypeForFile(absoluteFilePath(),
+                                                             QMimeDatabase::MatchContent);
+        setMimeTypeFromContent(mime);
+    }
+}
+
+/*!
+ * \brief DirItemInfo::setMimeType() sets a type found before, for instance saved in a \ref DirListingSnapshot
+ *
+ *  Neither the name nor the content are read again.
+ */
+void DirItemInfo::setMimeType(const QMimeType &mime)
+{
+    d_ptr->_mimeTypeIndex = DirItemInfoPrivate::mimeTypeIndex(mime);
+    d_ptr->_mimeTypeState = DirItemInfoPrivate::MimeTypeResolved;
+}
+
+/*!
+ * \brief DirItemInfo::setMimeTypeFromContent() sets the result of \ref resolveMimeTypeFromContent()
+ *  done in another copy of this item
+ */
+void DirItemInfo::setMimeTypeFromContent(const QMimeType &mime)
+{
+    if (mime.isValid() && !mime.isDefault()) {
+        d_ptr->_mimeTypeIndex = DirItemInfoPrivate::mimeTypeIndex(mime);
+    }
+    d_ptr->_mimeTypeState = DirItemInfoPrivate::MimeTypeResolved;
 }
 
 QString DirItemInfo::urlPath() const
@@ -356,9 +633,9 @@ QString DirItemInfo::filePathFrom(const QString &p) const
     return filepath;
 }
 
-bool DirItemInfo::permission(QFileDevice::Permissions permissions) const
+bool DirItemInfo::permission(QFileDevice::Permissions perms) const
 {
-    return (d_ptr->_permissions & permissions) == permissions;
+    return (QFile::Permissions(QFlag(d_ptr->_permissions)) & perms) == perms;
 }
 
 bool DirItemInfo::isSharedDir() const
@@ -413,25 +690,19 @@ void DirItemInfo::fillFromStatBuf(const struct stat &statBuffer)
 
     //size
     d_ptr->_size = statBuffer.st_size;
+    d_ptr->_mimeTypeState = DirItemInfoPrivate::MimeTypeUnresolved;
 
-    //times
-    d_ptr->_lastModified = statBuffer.st_mtime ?
-                           QDateTime::fromTime_t(statBuffer.st_mtime) :
-                           QDateTime(QDate(), QTime());
-
-    d_ptr->_created = statBuffer.st_ctime ?
-                      QDateTime::fromTime_t(statBuffer.st_ctime) :
-                      d_ptr->_lastModified;
-
-    d_ptr->_lastRead = statBuffer.st_atime ?
-                       QDateTime::fromTime_t(statBuffer.st_atime) :
-                       d_ptr->_lastModified;
+    //times, milliseconds are kept as QFileInfo does
+    const qint64 modified = msecsOf(statBuffer.st_mtim);
+    const qint64 created  = msecsOf(statBuffer.st_ctim);
+    const qint64 read     = msecsOf(statBuffer.st_atim);
+    d_ptr->_lastModified = modified ? modified : DirItemInfoPrivate::InvalidTime;
+    d_ptr->_created      = created  ? created  : d_ptr->_lastModified;
+    d_ptr->_lastRead     = read     ? read     : d_ptr->_lastModified;
 
-    /*
-     //user, group
-     userId_ =  statBuffer.st_uid;
-     groupId_ = statBuffer.st_gid;
-    */
+    //user, group
+    d_ptr->_ownerId = statBuffer.st_uid;
+    d_ptr->_groupId = statBuffer.st_gid;
 
     /*
      *  When handling filesystems other than local (e.g. any network)
@@ -502,7 +773,7 @@ void DirItemInfo::fillFromStatBuf(const struct stat &statBuffer)
     }
 
     //set full permissions flag
-    d_ptr->_permissions = readPermission | writePermission | execPermission;
+    d_ptr->_permissions = static_cast<quint16> (readPermission | writePermission | execPermission);
 
     // Type
     if ((statBuffer.st_mode & S_IFMT) == S_IFREG) {
@@ -518,6 +789,228 @@ void DirItemInfo::fillFromStatBuf(const struct stat &statBuffer)
     }
 }
 
+/*!
+ * \brief DirItemInfo::nameSortKey() creates the collation key of \ref fileName()
+ *
+ *  Comparing keys gives the same result as \ref compareName() and is much faster, but a key is
+ *  bigger than the rest of the item, so it is not kept: \ref sortItems() creates the keys
+ *  of a list for a single sort, see \ref sortIndexes().
+ */
+QCollatorSortKey DirItemInfo::nameSortKey() const
+{
+    return currentCollator(sortKeyGeneration.load()).sortKey(d_ptr->_fileName);
+}
+
+/*!
+ * \brief DirItemInfo::compareName() compares the names of this item and \a other as QCollator::compare() does
+ */
+int DirItemInfo::compareName(const DirItemInfo &other) const
+{
+    return currentCollator(sortKeyGeneration.load()).compare(d_ptr->_fileName, other.d_ptr->_fileName);
+}
+
+/*!
+ * \brief DirItemInfo::setNumericSortKeys() when \a numeric is true numbers inside names are compared by value
+ *
+ *  It affects the whole application, "file10" comes after "file9".
+ */
+void DirItemInfo::setNumericSortKeys(bool numeric)
+{
+    if (sortKeyNumeric.fetchAndStoreOrdered(numeric ? 1 : 0) != (numeric ? 1 : 0)) {
+        sortKeyGeneration.ref();
+    }
+}
+
+bool DirItemInfo::numericSortKeys()
+{
+    return sortKeyNumeric.load() != 0;
+}
+
+/*!
+ * \brief DirItemInfo::setMimeTypePolicy() sets how mime types are found, it affects the whole application
+ *
+ *  Items already resolved keep their mime type.
+ */
+void DirItemInfo::setMimeTypePolicy(MimeTypePolicy policy)
+{
+    mimePolicy.store(policy);
+}
+
+DirItemInfo::MimeTypePolicy DirItemInfo::mimeTypePolicy()
+{
+    return static_cast<MimeTypePolicy> (mimePolicy.load());
+}
+
+/*!
+ * \brief DirItemInfo::setLocalFileFromStatBuf() sets a local disk item from an already done stat()
+ *
+ *  It avoids the extra stat() calls done by QFileInfo, \ref fillFromStatBuf() is used
+ *  for size, times and type; readable/writable/executable come from \a access,
+ *  see \ref localFileAccess().
+ *
+ * \param path      the absolute path of the parent directory
+ * \param fileName  the item name
+ * \param isSymLink true if the entry is a symbolic link, \a statBuffer refers to its target
+ * \param access    R_OK, W_OK and X_OK bits granted to the current user
+ */
+void DirItemInfo::setLocalFileFromStatBuf(const QString &path, const QString &fileName,
+                                          const struct stat &statBuffer, bool isSymLink, int access)
+{
+    d_ptr->_isValid        = true;
+    d_ptr->_isLocal        = true;
+    d_ptr->_isAbsolute     = true;
+    d_ptr->_exists         = true;
+    d_ptr->_isSymLink      = isSymLink;
+    d_ptr->_needsStat      = false;
+    d_ptr->_path           = path;
+    d_ptr->_normalizedPath = path;
+    d_ptr->_fileName       = fileName;
+
+    fillFromStatBuf(statBuffer);
+
+    d_ptr->_isReadable   = (access & R_OK) != 0;
+    d_ptr->_isWritable   = (access & W_OK) != 0;
+    d_ptr->_isExecutable = (access & X_OK) != 0;
+
+    // "User" permissions refer to the current user as QFileInfo::permissions() does
+    QFile::Permissions perms = QFile::Permissions(QFlag(d_ptr->_permissions))
+                               & ~(QFile::ReadUser | QFile::WriteUser | QFile::ExeUser);
+    if (d_ptr->_isReadable) {
+        perms |= QFile::ReadUser;
+    }
+    if (d_ptr->_isWritable) {
+        perms |= QFile::WriteUser;
+    }
+    if (d_ptr->_isExecutable) {
+        perms |= QFile::ExeUser;
+    }
+    d_ptr->_permissions = static_cast<quint16> (perms);
+}
+
+/*!
+ * \brief DirItemInfo::localFileAccess() gets the access the current user has to \a name
+ *
+ *  QFileInfo asks access() for each permission, that takes supplementary groups and POSIX ACLs
+ *  into account. Here the owner permission bits are used for the items of \a userId, ACLs never
+ *  apply to the owner, other items are checked by faccessat(). No call is done for a permission
+ *  that no class has, an ACL cannot grant it either; only root gets it that way.
+ *
+ * \param dirFd      the parent directory descriptor, or AT_FDCWD when \a name is an absolute path
+ * \param statBuffer the stat() of \a name, links are followed
+ * \param userId     the effective user id
+ * \return R_OK, W_OK and X_OK bits
+ */
+int DirItemInfo::localFileAccess(int dirFd, const char *name,
+                                 const struct stat &statBuffer, uint userId)
+{
+    static const struct {
+        int    mode;
+        mode_t owner;
+        mode_t anyClass;
+    } accessBits[] = {
+        { R_OK, S_IRUSR, S_IRUSR | S_IRGRP | S_IROTH },
+        { W_OK, S_IWUSR, S_IWUSR | S_IWGRP | S_IWOTH },
+        { X_OK, S_IXUSR, S_IXUSR | S_IXGRP | S_IXOTH }
+    };
+    int access = 0;
+    const bool isOwner = userId != 0 && statBuffer.st_uid == userId;
+    for (uint counter = 0; counter < sizeof(accessBits) / sizeof(accessBits[0]); ++counter) {
+        if (isOwner) {
+            if (statBuffer.st_mode & accessBits[counter].owner) {
+                access |= accessBits[counter].mode;
+            }
+        } else if ((userId == 0 || (statBuffer.st_mode & accessBits[counter].anyClass))
+                   && ::faccessat(dirFd, name, accessBits[counter].mode, AT_EACCESS) == 0) {
+            access |= accessBits[counter].mode;
+        }
+    }
+    return access;
+}
+
+/*!
+ * \brief DirItemInfo::setLocalFileFromDirEntry() sets a local disk item knowing only its name and type
+ *
+ *  It is what a directory entry (readdir) gives, size, times and permissions are unknown
+ *  until \ref resolvePendingStat() is called, meanwhile \ref needsStat() returns true.
+ *  The readable/writable/executable flags are then meaningless rather than denied,
+ *  callers must check \ref needsStat() or resolve the stat before relying on them.
+ *  Symbolic links must not be set this way, the type of the target is not known.
+ *
+ * \param path the absolute path of the parent directory
+ */
+void DirItemInfo::setLocalFileFromDirEntry(const QString &path, const QString &fileName, bool isDir)
+{
+    d_ptr->_isValid        = true;
+    d_ptr->_isLocal        = true;
+    d_ptr->_isAbsolute     = true;
+    d_ptr->_exists         = true;
+    d_ptr->_isDir          = isDir;
+    d_ptr->_isFile         = !isDir;
+    d_ptr->_needsStat      = true;
+    d_ptr->_path           = path;
+    d_ptr->_normalizedPath = path;
+    d_ptr->_fileName       = fileName;
+}
+
+/*!
+ * \brief DirItemInfo::needsStat()
+ * \return true when the item was created by \ref setLocalFileFromDirEntry() and was not stat'ed yet
+ */
+bool DirItemInfo::needsStat() const
+{
+    return d_ptr->_needsStat;
+}
+
+/*!
+ * \brief DirItemInfo::resolvePendingStat() does the stat() left by \ref setLocalFileFromDirEntry()
+ *
+ *  It reads the disk, it is meant to run in an IO thread.
+ * \return false if the file no longer exists
+ */
+bool DirItemInfo::resolvePendingStat()
+{
+    if (!d_ptr->_needsStat) {
+        return d_ptr->_exists;
+    }
+    struct stat st;
+    const QByteArray name = QFile::encodeName(absoluteFilePath());
+    if (::stat(name.constData(), &st) != 0 && ::lstat(name.constData(), &st) != 0) {
+        d_ptr->_needsStat = false;
+        d_ptr->_exists    = false;
+        return false;
+    }
+    const QString path(d_ptr->_path);
+    const QString fileName(d_ptr->_fileName);
+    setLocalFileFromStatBuf(path, fileName, st, false,
+                            localFileAccess(AT_FDCWD, name.constData(), st, ::geteuid()));
+    return true;
+}
+
+/*!
+ * \brief DirItemInfo::setMetaDataFrom() copies what a stat() gives from \a other
+ *
+ *  Used to merge the result of \ref resolvePendingStat() done in another copy of this item,
+ *  the mime type of this item is kept.
+ */
+void DirItemInfo::setMetaDataFrom(const DirItemInfo &other)
+{
+    const DirItemInfoPrivate *src = other.d_ptr.constData();
+    d_ptr->_exists       = src->_exists;
+    d_ptr->_isFile       = src->_isFile;
+    d_ptr->_isDir        = src->_isDir;
+    d_ptr->_isReadable   = src->_isReadable;
+    d_ptr->_isWritable   = src->_isWritable;
+    d_ptr->_isExecutable = src->_isExecutable;
+    d_ptr->_permissions  = src->_permissions;
+    d_ptr->_ownerId      = src->_ownerId;
+    d_ptr->_groupId      = src->_groupId;
+    d_ptr->_size         = src->_size;
+    d_ptr->_created      = src->_created;
+    d_ptr->_lastModified = src->_lastModified;
+    d_ptr->_lastRead     = src->_lastRead;
+    d_ptr->_needsStat    = src->_needsStat;
+}
+
 QString DirItemInfo::removeExtraSlashes(const QString &url, int firstSlashIndex)
 {
     QString ret;
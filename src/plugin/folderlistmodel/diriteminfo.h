@@ -32,6 +32,7 @@
 #include <QMimeDatabase>
 
 class DirItemInfoPrivate;
+class QCollatorSortKey;
 
 /*!
  * \brief The DirItemInfo class
@@ -52,8 +53,19 @@ public:
     virtual ~DirItemInfo();
 
 public:
-    bool isSelected() const;
-    bool setSelection(bool selected);
+    /*!
+     * \brief The MimeTypePolicy enum says how \ref mimeType() is found
+     *
+     *  The name is always used first, so \ref mimeType() never reads the disk,
+     *  reading the content is left to a background pass, see \ref needsMimeTypeFromContent()
+     */
+    enum MimeTypePolicy {
+        MimeTypeFromExtension,             //!< the file content is never read
+        MimeTypeFromExtensionThenContent,  //!< the content is read when the name does not give a known type
+        MimeTypeFromContent                //!< the content of every file is read
+    };
+
+public:
     virtual bool isValid() const;
 
     /*!
@@ -100,6 +112,7 @@ public:
     virtual QDateTime created() const;
     virtual QDateTime lastModified() const;
     virtual QDateTime lastRead() const;
+    qint64 lastModifiedMSecs() const;
     virtual QMimeType mimeType() const;
     virtual bool isHost() const;
     virtual bool isSharedDir() const;
@@ -112,18 +125,38 @@ public:
     virtual void setFile(const QString &fullname);
     virtual bool permission(QFile::Permissions permissions) const;
     void fillFromStatBuf(const struct stat &statBuffer);
+    void setLocalFileFromStatBuf(const QString &path, const QString &fileName,
+                                 const struct stat &statBuffer, bool isSymLink, int access);
+    void setLocalFileFromDirEntry(const QString &path, const QString &fileName, bool isDir);
+    bool needsStat() const;
+    bool resolvePendingStat();
+    void setMetaDataFrom(const DirItemInfo &other);
     void setAsHost();
     void setAsShare();
+    QCollatorSortKey nameSortKey() const;
+    int  compareName(const DirItemInfo &other) const;
+    void resolveMimeTypeFromName();
+    bool needsMimeTypeFromContent() const;
+    void resolveMimeTypeFromContent();
+    void setMimeTypeFromContent(const QMimeType &mime);
+    void setMimeType(const QMimeType &mime);
 
 public:
     static QString removeExtraSlashes(const QString &url, int firstSlashIndex = -1);
+    static void    setNumericSortKeys(bool numeric);
+    static bool    numericSortKeys();
+    static void    setMimeTypePolicy(MimeTypePolicy policy);
+    static MimeTypePolicy mimeTypePolicy();
+    static int     localFileAccess(int dirFd, const char *name,
+                                   const struct stat &statBuffer, uint userId);
+
+    virtual uint ownerId() const;
+    virtual uint groupId() const;
 
 #if 0
     virtual QString path() const;
     virtual QString owner() const;
-    virtual uint ownerId() const;
     virtual QString group() const;
-    virtual uint groupId() const;
 #endif
 
 protected:
@@ -131,6 +164,8 @@ protected:
 
 protected:
     QSharedDataPointer<DirItemInfoPrivate> d_ptr;
+
+    friend class DirItemInfoStore;
 };
 
 typedef QVector<DirItemInfo> DirItemInfoList;
@@ -139,6 +174,14 @@ Q_DECLARE_SHARED(DirItemInfo)
 Q_DECLARE_METATYPE(DirItemInfo)
 
 
+/*!
+ * \brief The DirItemInfoPrivate class holds the data of a \ref DirItemInfo
+ *
+ *  A listing may have hundreds of thousands of them, so it is kept small: times are stored as
+ *  msecs since epoch and converted to QDateTime only when asked, permissions use 16 bits,
+ *  the parent path is shared by all items of the same directory and the mime type is an index
+ *  into a table shared by all items.
+ */
 class  DirItemInfoPrivate : public QSharedData
 {
 public:
@@ -147,11 +190,25 @@ public:
     DirItemInfoPrivate(const QFileInfo &fi);
     void setFileInfo(const QFileInfo &);
 
+    static QString   sharedPath(const QString &path);
+    static qint64    toMSecs(const QDateTime &dateTime);
+    static QDateTime fromMSecs(qint64 msecs);
+
+    enum MimeTypeState {
+        MimeTypeUnresolved,
+        MimeTypeNeedsContent,   //!< \ref _mimeTypeIndex comes from the name, the content must still be read
+        MimeTypeResolved
+    };
+
+    QMimeType mimeTypeFromName(MimeTypeState *state) const;
+    void resolveMimeTypeFromName();
+    static quint16   mimeTypeIndex(const QMimeType &mime);
+    static QMimeType mimeTypeAt(quint16 index);
+
 public:
     bool _isValid : 1;
     bool _isLocal : 1;
     bool _isRemote : 1;
-    bool _isSelected : 1;
     bool _isAbsolute : 1;
     bool _exists : 1;
     bool _isFile : 1;
@@ -166,17 +223,26 @@ public:
     bool _isWorkGroup : 1;      //!< specific to Samba
     bool _isNetworkShare : 1;   //!< samba share (entry point)
     bool _needsAuthentication: 1; //!< the url may require authentication do access
+    bool _needsStat : 1;          //!< only name and type are known, see \ref DirItemInfo::setLocalFileFromDirEntry()
+    qint8 _mimeTypeState;          //!< a \ref MimeTypeState, it fills the byte left by the flags above
 
-    QFile::Permissions _permissions;
+    quint16 _permissions;          //!< QFile::Permissions, all its bits fit in 16 bits
+    quint16 _mimeTypeIndex;        //!< set by \ref resolveMimeTypeFromName(), see \ref mimeTypeAt()
+    quint32 _ownerId;              //!< st_uid or \ref UnknownId
+    quint32 _groupId;              //!< st_gid or \ref UnknownId
     qint64 _size;
-    QDateTime _created;
-    QDateTime _lastModified;
-    QDateTime _lastRead;
-    QString _path;
+    qint64 _created;               //!< msecs since epoch or \ref InvalidTime, see \ref fromMSecs()
+    qint64 _lastModified;
+    qint64 _lastRead;
+    QString _path;                 //!< shares its data with the other items of the directory, see \ref sharedPath()
     QString _fileName;
-    QString _normalizedPath;
+    QString _normalizedPath;       //!< usually shares its data with \ref _path
     QString _authenticationPath;
 
+    static const qint64 InvalidTime;
+    static const quint32 UnknownId;
+    static const quint16 NoMimeType;
+
     static QMimeDatabase mimeDatabase;
 };
 
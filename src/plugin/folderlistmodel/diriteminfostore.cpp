@@ -0,0 +1,234 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: diriteminfostore.cpp
+ * Date: 17/10/2026
+ */
+
+#include "diriteminfostore.h"
+
+#include <typeinfo>
+
+DirItemInfoStore::DirItemInfoStore()
+{
+}
+
+/*!
+ * \brief DirItemInfoStore::isPackable() true when \a item can be rebuilt from the columns
+ *
+ *  Subclasses, like trash and samba items, keep data of their own and are stored as they are.
+ */
+bool DirItemInfoStore::isPackable(const DirItemInfo &item)
+{
+    const DirItemInfoPrivate *d = item.d_ptr.constData();
+    return typeid(item) == typeid(DirItemInfo)
+           && d->_authenticationPath.isEmpty()
+           && d->_normalizedPath == d->_path;
+}
+
+void DirItemInfoStore::append(const DirItemInfo &item)
+{
+    const int index = count();
+    const DirItemInfoPrivate *d = item.d_ptr.constData();
+    quint32 flags = 0;
+    if (!isPackable(item)) {
+        flags = Whole;
+        m_whole.insert(index, item);
+    } else {
+        flags = (d->_isValid             ? IsValid             : 0)
+                | (d->_isLocal             ? IsLocal             : 0)
+                | (d->_isRemote            ? IsRemote            : 0)
+                | (d->_isAbsolute          ? IsAbsolute          : 0)
+                | (d->_exists              ? Exists              : 0)
+                | (d->_isFile              ? IsFile              : 0)
+                | (d->_isDir               ? IsDir               : 0)
+                | (d->_isSymLink           ? IsSymLink           : 0)
+                | (d->_isRoot              ? IsRoot              : 0)
+                | (d->_isReadable          ? IsReadable          : 0)
+                | (d->_isWritable          ? IsWritable          : 0)
+                | (d->_isExecutable        ? IsExecutable        : 0)
+                | (d->_isLocalSharedDir    ? IsLocalSharedDir    : 0)
+                | (d->_isHost              ? IsHost              : 0)
+                | (d->_isWorkGroup         ? IsWorkGroup         : 0)
+                | (d->_isNetworkShare      ? IsNetworkShare      : 0)
+                | (d->_needsAuthentication ? NeedsAuthentication : 0)
+                | (d->_needsStat           ? NeedsStat           : 0);
+    }
+
+    // items come directory by directory, the last parent is usually the same
+    if (m_paths.isEmpty() || (m_paths.last().constData() != d->_path.constData()
+                              && m_paths.last() != d->_path)) {
+        m_paths.append(d->_path);
+    }
+
+    quint16 mime = DirItemInfoPrivate::NoMimeType;
+    qint8   mimeTypeState = d->_mimeTypeState;
+    if (mimeTypeState != DirItemInfoPrivate::MimeTypeUnresolved && !(flags & Whole)) {
+        mime = d->_mimeTypeIndex;
+    }
+    flags |= quint32(quint8(mimeTypeState)) << MimeTypeStateShift;
+
+    if (!(flags & Whole)) {
+        m_names += d->_fileName;
+    }
+    m_sizes.append(d->_size);
+    m_lastModified.append(d->_lastModified);
+    m_created.append(d->_created);
+    m_lastRead.append(d->_lastRead);
+    m_ownerIds.append(d->_ownerId);
+    m_groupIds.append(d->_groupId);
+    m_flags.append(flags);
+    m_permissions.append(d->_permissions);
+    m_mimes.append(mime);
+    m_pathIndexes.append(m_paths.count() - 1);
+    m_nameEnds.append(m_names.size());
+}
+
+void DirItemInfoStore::append(const DirItemInfoList &items)
+{
+    reserve(count() + items.count());
+    for (int counter = 0; counter < items.count(); ++counter) {
+        append(items.at(counter));
+    }
+}
+
+void DirItemInfoStore::reserve(int count)
+{
+    m_sizes.reserve(count);
+    m_lastModified.reserve(count);
+    m_created.reserve(count);
+    m_lastRead.reserve(count);
+    m_ownerIds.reserve(count);
+    m_groupIds.reserve(count);
+    m_flags.reserve(count);
+    m_permissions.reserve(count);
+    m_mimes.reserve(count);
+    m_pathIndexes.reserve(count);
+    m_nameEnds.reserve(count);
+}
+
+/*!
+ * \brief DirItemInfoStore::squeeze() frees the memory reserved and not used, once the listing is complete
+ */
+void DirItemInfoStore::squeeze()
+{
+    m_sizes.squeeze();
+    m_lastModified.squeeze();
+    m_created.squeeze();
+    m_lastRead.squeeze();
+    m_ownerIds.squeeze();
+    m_groupIds.squeeze();
+    m_flags.squeeze();
+    m_permissions.squeeze();
+    m_mimes.squeeze();
+    m_pathIndexes.squeeze();
+    m_nameEnds.squeeze();
+    m_names.squeeze();
+}
+
+void DirItemInfoStore::clear()
+{
+    *this = DirItemInfoStore();
+}
+
+int DirItemInfoStore::count() const
+{
+    return m_flags.count();
+}
+
+bool DirItemInfoStore::isEmpty() const
+{
+    return m_flags.isEmpty();
+}
+
+/*!
+ * \brief DirItemInfoStore::at() creates the item \a index, it shares the parent path with the other items
+ */
+DirItemInfo DirItemInfoStore::at(int index) const
+{
+    const quint32 flags = m_flags.at(index);
+    if (flags & Whole) {
+        return m_whole.value(index);
+    }
+
+    DirItemInfo item;
+    DirItemInfoPrivate *d = item.d_ptr.data();
+    d->_isValid             = flags & IsValid;
+    d->_isLocal             = flags & IsLocal;
+    d->_isRemote            = flags & IsRemote;
+    d->_isAbsolute          = flags & IsAbsolute;
+    d->_exists              = flags & Exists;
+    d->_isFile              = flags & IsFile;
+    d->_isDir               = flags & IsDir;
+    d->_isSymLink           = flags & IsSymLink;
+    d->_isRoot              = flags & IsRoot;
+    d->_isReadable          = flags & IsReadable;
+    d->_isWritable          = flags & IsWritable;
+    d->_isExecutable        = flags & IsExecutable;
+    d->_isLocalSharedDir    = flags & IsLocalSharedDir;
+    d->_isHost              = flags & IsHost;
+    d->_isWorkGroup         = flags & IsWorkGroup;
+    d->_isNetworkShare      = flags & IsNetworkShare;
+    d->_needsAuthentication = flags & NeedsAuthentication;
+    d->_needsStat           = flags & NeedsStat;
+    d->_mimeTypeState       = static_cast<qint8> (flags >> MimeTypeStateShift);
+    d->_mimeTypeIndex       = m_mimes.at(index);
+
+    const int nameStart = index > 0 ? m_nameEnds.at(index - 1) : 0;
+    d->_path            = m_paths.at(m_pathIndexes.at(index));
+    d->_normalizedPath  = d->_path;
+    d->_fileName        = m_names.mid(nameStart, m_nameEnds.at(index) - nameStart);
+    d->_permissions     = m_permissions.at(index);
+    d->_ownerId         = m_ownerIds.at(index);
+    d->_groupId         = m_groupIds.at(index);
+    d->_size            = m_sizes.at(index);
+    d->_lastModified    = m_lastModified.at(index);
+    d->_created         = m_created.at(index);
+    d->_lastRead        = m_lastRead.at(index);
+    return item;
+}
+
+DirItemInfoList DirItemInfoStore::toList() const
+{
+    DirItemInfoList ret;
+    ret.reserve(count());
+    for (int counter = 0; counter < count(); ++counter) {
+        ret.append(at(counter));
+    }
+    return ret;
+}
+
+/*!
+ * \brief DirItemInfoStore::memoryUsage() approximate bytes used by the columns and the strings
+ */
+qint64 DirItemInfoStore::memoryUsage() const
+{
+    qint64 ret = sizeof(DirItemInfoStore);
+    ret += (m_sizes.capacity() + m_lastModified.capacity() + m_created.capacity() + m_lastRead.capacity())
+           * qint64(sizeof(qint64));
+    ret += (m_ownerIds.capacity() + m_groupIds.capacity() + m_flags.capacity()
+            + m_pathIndexes.capacity() + m_nameEnds.capacity()) * qint64(sizeof(quint32));
+    ret += (m_permissions.capacity() + m_mimes.capacity()) * qint64(sizeof(quint16));
+    ret += m_names.capacity() * qint64(sizeof(QChar));
+    for (int counter = 0; counter < m_paths.count(); ++counter) {
+        ret += m_paths.at(counter).size() * qint64(sizeof(QChar));
+    }
+    QHash<int, DirItemInfo>::ConstIterator it = m_whole.constBegin();
+    for ( ; it != m_whole.constEnd(); ++it) {
+        ret += sizeof(DirItemInfoPrivate) + it.value().absoluteFilePath().size() * qint64(sizeof(QChar));
+    }
+    return ret;
+}
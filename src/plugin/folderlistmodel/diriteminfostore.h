@@ -0,0 +1,101 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: diriteminfostore.h
+ * Date: 17/10/2026
+ */
+
+#ifndef DIRITEMINFOSTORE_H
+#define DIRITEMINFOSTORE_H
+
+#include "diriteminfo.h"
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+#include <QStringList>
+
+/*!
+ * \brief The DirItemInfoStore class keeps a listing in a compact struct of arrays
+ *
+ *  Each column is a plain array: sizes and times as qint64 msecs, owner and group ids, permissions
+ *  and the flag bits packed in 16 and 32 bits. Names are stored one after the other in a single string,
+ *  parent paths are stored once and referred to by index, mime types keep their \ref DirItemInfoPrivate::_mimeTypeIndex.
+ *  An item takes about 60 bytes plus its name, instead of the \ref DirItemInfoPrivate and its strings.
+ *
+ *  \ref DirItemInfo objects are created on demand by \ref at().
+ *  Items that are not plain local items are kept as they are, see \ref isPackable().
+ */
+class DirItemInfoStore
+{
+public:
+    DirItemInfoStore();
+
+    void            append(const DirItemInfo &item);
+    void            append(const DirItemInfoList &items);
+    void            reserve(int count);
+    void            squeeze();
+    void            clear();
+
+    int             count() const;
+    bool            isEmpty() const;
+    DirItemInfo     at(int index) const;
+    DirItemInfoList toList() const;
+    qint64          memoryUsage() const;
+
+    static bool     isPackable(const DirItemInfo &item);
+
+private:
+    enum Flag {
+        IsValid             = 0x00000001,
+        IsLocal             = 0x00000002,
+        IsRemote            = 0x00000004,
+        IsAbsolute          = 0x00000008,
+        Exists              = 0x00000010,
+        IsFile              = 0x00000020,
+        IsDir               = 0x00000040,
+        IsSymLink           = 0x00000080,
+        IsRoot              = 0x00000100,
+        IsReadable          = 0x00000200,
+        IsWritable          = 0x00000400,
+        IsExecutable        = 0x00000800,
+        IsLocalSharedDir    = 0x00001000,
+        IsHost              = 0x00002000,
+        IsWorkGroup         = 0x00004000,
+        IsNetworkShare      = 0x00008000,
+        NeedsAuthentication = 0x00010000,
+        NeedsStat           = 0x00020000,
+        Whole               = 0x00040000,   //!< the item is in \ref m_whole
+        MimeTypeStateShift  = 24            //!< a \ref DirItemInfoPrivate::MimeTypeState in the top byte
+    };
+
+    QVector<qint64>   m_sizes;
+    QVector<qint64>   m_lastModified;
+    QVector<qint64>   m_created;
+    QVector<qint64>   m_lastRead;
+    QVector<quint32>  m_ownerIds;
+    QVector<quint32>  m_groupIds;
+    QVector<quint32>  m_flags;         //!< \ref Flag bits
+    QVector<quint16>  m_permissions;
+    QVector<quint16>  m_mimes;         //!< \ref DirItemInfoPrivate::_mimeTypeIndex or \ref DirItemInfoPrivate::NoMimeType
+    QVector<quint32>  m_pathIndexes;   //!< index in \ref m_paths
+    QVector<quint32>  m_nameEnds;      //!< a name starts where the previous one ends in \ref m_names
+    QString           m_names;
+    QStringList       m_paths;
+    QHash<int, DirItemInfo> m_whole;   //!< items that are not \ref isPackable(), by index
+};
+
+#endif // DIRITEMINFOSTORE_H
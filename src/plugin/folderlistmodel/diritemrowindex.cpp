@@ -0,0 +1,125 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: diritemrowindex.cpp
+ * Date: 17/10/2026
+ */
+
+#include "diritemrowindex.h"
+
+#include <QDebug>
+
+DirItemRowIndex::DirItemRowIndex(const DirItemInfoList *items)
+    : m_items(items)
+    , m_valid(false)
+{
+}
+
+void DirItemRowIndex::invalidate()
+{
+    m_valid = false;
+    m_rows.clear();
+    m_shifts.clear();
+}
+
+void DirItemRowIndex::rebuild()
+{
+    m_rows.clear();
+    m_shifts.clear();
+    const int count = m_items->count();
+    m_rows.reserve(count);
+    for (int row = 0; row < count; ++row) {
+        Entry entry = { row, 0 };
+        m_rows.insert(m_items->at(row).absoluteFilePath(), entry);
+    }
+    m_valid = true;
+}
+
+void DirItemRowIndex::addShift(int threshold, int delta)
+{
+    if (m_shifts.count() >= DIR_ITEM_ROW_INDEX_MAX_SHIFTS) {
+        // rebuilt on the next lookup
+        invalidate();
+    } else {
+        Shift shift = { threshold, delta };
+        m_shifts.append(shift);
+    }
+}
+
+/*!
+ * \brief DirItemRowIndex::rowsInserted() must be called after \a count items were inserted at \a row
+ */
+void DirItemRowIndex::rowsInserted(int row, int count)
+{
+    if (!m_valid) {
+        return;
+    }
+    // appended rows do not move any other row
+    if (row + count < m_items->count()) {
+        addShift(row, count);
+    }
+    if (m_valid) {
+        for (int counter = row; counter < row + count; ++counter) {
+            Entry entry = { counter, m_shifts.count() };
+            m_rows.insert(m_items->at(counter).absoluteFilePath(), entry);
+        }
+    }
+}
+
+/*!
+ * \brief DirItemRowIndex::rowsAboutToBeRemoved() must be called before \a count items at \a row are removed
+ */
+void DirItemRowIndex::rowsAboutToBeRemoved(int row, int count)
+{
+    if (!m_valid) {
+        return;
+    }
+    for (int counter = row; counter < row + count; ++counter) {
+        m_rows.remove(m_items->at(counter).absoluteFilePath());
+    }
+    addShift(row + count, -count);
+}
+
+/*!
+ * \brief DirItemRowIndex::rowOf() returns the row of \a absoluteFilePath or -1 if it is not in the list
+ */
+int DirItemRowIndex::rowOf(const QString &absoluteFilePath)
+{
+    if (!m_valid) {
+        rebuild();
+    }
+    QHash<QString, Entry>::Iterator it = m_rows.find(absoluteFilePath);
+    if (it == m_rows.end()) {
+        return -1;
+    }
+
+    int row = it->row;
+    for (int counter = it->firstShift; counter < m_shifts.count(); ++counter) {
+        if (row >= m_shifts.at(counter).threshold) {
+            row += m_shifts.at(counter).delta;
+        }
+    }
+    it->row        = row;
+    it->firstShift = m_shifts.count();
+
+    if (row < 0 || row >= m_items->count() || m_items->at(row).absoluteFilePath() != absoluteFilePath) {
+        // some change was not reported
+        qWarning() << Q_FUNC_INFO << "index out of date for" << absoluteFilePath;
+        rebuild();
+        return m_rows.value(absoluteFilePath, Entry{ -1, 0 }).row;
+    }
+    return row;
+}
@@ -0,0 +1,75 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: diritemrowindex.h
+ * Date: 17/10/2026
+ */
+
+#ifndef DIRITEMROWINDEX_H
+#define DIRITEMROWINDEX_H
+
+#include "diriteminfo.h"
+
+#include <QHash>
+#include <QVector>
+#include <QString>
+
+/*!
+ *  Number of pending row shifts kept before the index is built again
+ */
+#define DIR_ITEM_ROW_INDEX_MAX_SHIFTS   64
+
+/*!
+ * \brief The DirItemRowIndex class maps absolute file paths to rows of a \ref DirItemInfoList
+ *
+ *  It replaces walking the whole list in \ref DirModel::rowOfItem() when the list is not sorted by name.
+ *
+ *  The index is built on the first lookup. Inserting or removing rows does not rebuild it: each change
+ *  is recorded as a shift (rows >= threshold move by delta) and rows are fixed up when they are looked up.
+ *  Each entry remembers how many shifts existed when it was stored, so it only applies newer shifts.
+ *  A reset or a reorder invalidates the whole index.
+ */
+class DirItemRowIndex
+{
+public:
+    explicit DirItemRowIndex(const DirItemInfoList *items);
+
+    int      rowOf(const QString &absoluteFilePath);
+    void     rowsInserted(int row, int count);
+    void     rowsAboutToBeRemoved(int row, int count);
+    void     invalidate();
+
+private:
+    void     rebuild();
+    void     addShift(int threshold, int delta);
+
+private:
+    struct Entry {
+        int row;
+        int firstShift;  //!< shifts before this one were already applied to \a row
+    };
+    struct Shift {
+        int threshold;
+        int delta;
+    };
+
+    const DirItemInfoList   *m_items;
+    QHash<QString, Entry>    m_rows;
+    QVector<Shift>           m_shifts;
+    bool                     m_valid;
+};
+
+#endif // DIRITEMROWINDEX_H
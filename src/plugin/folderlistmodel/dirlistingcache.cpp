@@ -0,0 +1,199 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: dirlistingcache.cpp
+ * Date: 17/10/2026
+ */
+
+#include "dirlistingcache.h"
+#include "dirlistingsnapshot.h"
+#include "ioscheduler.h"
+#include "ioworkerthread.h"
+
+#include <QMutexLocker>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QDebug>
+
+#include <limits>
+
+Q_GLOBAL_STATIC(DirListingCache, dirListingCache)
+
+
+DirListingCache::DirListingCache(int maxCost)
+    : m_snapshots(maxCost)
+    , m_snapshotsDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                     + QLatin1String("/listings"))
+{
+}
+
+DirListingCache *DirListingCache::instance()
+{
+    return dirListingCache();
+}
+
+/*!
+ * \brief DirListingCache::makeKey() a listing depends on the directory and on every filter applied to it
+ */
+QString DirListingCache::makeKey(const QString &urlPath, QDir::Filters filter,
+                                 const QStringList &nameFilters, bool filterDirectories)
+{
+    return urlPath + QLatin1Char('\n')
+           + QString::number(static_cast<int> (filter)) + QLatin1Char('\n')
+           + (filterDirectories ? QLatin1Char('d') : QLatin1Char('-')) + QLatin1Char('\n')
+           + nameFilters.join(QLatin1Char('\n'));
+}
+
+int DirListingCache::cost(const DirItemInfoStore &items)
+{
+    return static_cast<int> (qMin(items.memoryUsage(), qint64(std::numeric_limits<int>::max())));
+}
+
+/*!
+ * \brief DirListingCache::insert() stores \a items as the listing of \a key
+ * \param dirModified modification time of the directory when \a items were read, snapshots without it are not stored
+ */
+void DirListingCache::insert(const QString &key, const QString &dirPath,
+                             const QDateTime &dirModified, const DirItemInfoList &items)
+{
+    if (!dirModified.isValid()) {
+        return;
+    }
+    // packed before taking the lock, the model keeps using its own items
+    Snapshot *snapshot    = new Snapshot;
+    snapshot->dirModified = dirModified;
+    snapshot->items.append(items);
+    snapshot->items.squeeze();
+    const int itemsCost   = cost(snapshot->items);
+    const QPair<QDateTime, int> savedState(dirModified, items.count());
+
+    QMutexLocker lock(&m_mutex);
+    // QCache deletes the snapshot when it is bigger than maxCost()
+    m_snapshots.insert(key, snapshot, itemsCost);
+
+#if DEBUG_MESSAGES
+    qDebug() << Q_FUNC_INFO << "items:" << items.count() << "cost:" << itemsCost
+             << "totalCost:" << m_snapshots.totalCost();
+#endif
+
+    if (!m_snapshotsDir.isEmpty() && m_saved.value(key) != savedState) {
+        m_saved.insert(key, savedState);
+        const QString fileName = snapshotFileName(key);
+        lock.unlock();
+        IOScheduler::instance()->pool(IOScheduler::LocalDiskPool)->addRequest(
+            new DirListingSnapshotWriter(fileName, dirPath, dirModified, items));
+    }
+}
+
+/*!
+ * \brief DirListingCache::find() gets the listing of \a key if the directory has not changed
+ * \param dirModified current modification time of the directory
+ * \param items receives the snapshot
+ * \return true when a valid snapshot exists
+ */
+bool DirListingCache::find(const QString &key, const QString &dirPath,
+                           const QDateTime &dirModified, DirItemInfoList &items)
+{
+    QMutexLocker lock(&m_mutex);
+    Snapshot *snapshot = m_snapshots.object(key);
+    if (snapshot == 0) {
+        // not in memory, perhaps it was saved by a previous run
+        if (m_snapshotsDir.isEmpty()) {
+            items.clear();
+            return false;
+        }
+        // the file is read without the lock, other models keep using the cache meanwhile
+        const QString fileName = snapshotFileName(key);
+        lock.unlock();
+        if (!DirListingSnapshot::read(fileName, dirPath, dirModified, items)) {
+            items.clear();
+            return false;
+        }
+        snapshot              = new Snapshot;
+        snapshot->dirModified = dirModified;
+        snapshot->items.append(items);
+        snapshot->items.squeeze();
+        const int itemsCost   = cost(snapshot->items);
+        lock.relock();
+        m_saved.insert(key, qMakePair(dirModified, items.count()));
+        m_snapshots.insert(key, snapshot, itemsCost);
+        return true;
+    }
+    if (snapshot->dirModified != dirModified) {
+        m_snapshots.remove(key);
+        return false;
+    }
+    items = snapshot->items.toList();
+    return true;
+}
+
+void DirListingCache::remove(const QString &key)
+{
+    QMutexLocker lock(&m_mutex);
+    m_snapshots.remove(key);
+}
+
+void DirListingCache::clear()
+{
+    QMutexLocker lock(&m_mutex);
+    m_snapshots.clear();
+}
+
+/*!
+ * \brief DirListingCache::setSnapshotsDir() sets where snapshot files are saved, an empty \a dir disables them
+ */
+void DirListingCache::setSnapshotsDir(const QString &dir)
+{
+    QMutexLocker lock(&m_mutex);
+    m_snapshotsDir = dir;
+    m_saved.clear();
+}
+
+QString DirListingCache::snapshotsDir() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_snapshotsDir;
+}
+
+QString DirListingCache::snapshotFileName(const QString &key) const
+{
+    QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+    return m_snapshotsDir + QLatin1Char('/') + QLatin1String(hash.toHex()) + QLatin1String(".snapshot");
+}
+
+void DirListingCache::setMaxCost(int cost)
+{
+    QMutexLocker lock(&m_mutex);
+    m_snapshots.setMaxCost(cost);
+}
+
+int DirListingCache::maxCost() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_snapshots.maxCost();
+}
+
+int DirListingCache::totalCost() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_snapshots.totalCost();
+}
+
+int DirListingCache::count() const
+{
+    QMutexLocker lock(&m_mutex);
+    return m_snapshots.count();
+}
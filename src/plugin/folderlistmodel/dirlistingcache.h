@@ -0,0 +1,94 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: dirlistingcache.h
+ * Date: 17/10/2026
+ */
+
+#ifndef DIRLISTINGCACHE_H
+#define DIRLISTINGCACHE_H
+
+#include "diriteminfo.h"
+#include "diriteminfostore.h"
+
+#include <QCache>
+#include <QHash>
+#include <QPair>
+#include <QMutex>
+#include <QDateTime>
+#include <QDir>
+
+/*!
+ *  Approximate memory (in bytes) all snapshots can use together
+ */
+#define DIRLIST_CACHE_MAX_COST    (16 * 1024 * 1024)
+
+/*!
+ * \brief The DirListingCache class keeps the last directory listings in memory
+ *
+ *  It is shared by all \ref DirModel objects, so \ref DirModel::goBack(), \ref DirModel::cdUp()
+ *  or another tab showing a folder already seen do not need to wait for the disk.
+ *
+ *  Snapshots are kept in a \ref DirItemInfoStore, the cost is its memory usage, and
+ *  are evicted in LRU order when the total cost reaches \ref maxCost().
+ *  A snapshot is only returned by \ref find() while the modification time of its directory
+ *  is the same as when the snapshot was taken, otherwise it is dropped.
+ *
+ *  Snapshots are also saved in \ref snapshotsDir() as \ref DirListingSnapshot files,
+ *  so the first \ref find() after the application starts does not need to read the directory.
+ */
+class DirListingCache
+{
+public:
+    explicit DirListingCache(int maxCost = DIRLIST_CACHE_MAX_COST);
+
+    static DirListingCache *instance();
+
+    static QString makeKey(const QString &urlPath, QDir::Filters filter,
+                           const QStringList &nameFilters, bool filterDirectories);
+
+    void      insert(const QString &key, const QString &dirPath,
+                     const QDateTime &dirModified, const DirItemInfoList &items);
+    bool      find(const QString &key, const QString &dirPath,
+                   const QDateTime &dirModified, DirItemInfoList &items);
+    void      remove(const QString &key);
+    void      clear();
+
+    void      setSnapshotsDir(const QString &dir);
+    QString   snapshotsDir() const;
+
+    void      setMaxCost(int cost);
+    int       maxCost() const;
+    int       totalCost() const;
+    int       count() const;
+
+private:
+    static int cost(const DirItemInfoStore &items);
+    QString    snapshotFileName(const QString &key) const;
+
+private:
+    struct Snapshot {
+        QDateTime        dirModified;
+        DirItemInfoStore items;
+    };
+
+    mutable QMutex             m_mutex;
+    QCache<QString, Snapshot>  m_snapshots;
+    QString                    m_snapshotsDir;  //!< empty disables the files
+    QHash<QString, QPair<QDateTime, int> > m_saved; //!< directory time and count of each file saved or read
+};
+
+#endif // DIRLISTINGCACHE_H
@@ -0,0 +1,361 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: dirlistingsnapshot.cpp
+ * Date: 17/10/2026
+ */
+
+#include "dirlistingsnapshot.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDir>
+#include <QVector>
+#include <QHash>
+#include <QMimeDatabase>
+#include <QDebug>
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+
+namespace {
+
+const quint32 SnapshotMagic = 0x534c4d46; // "FMLS"
+const quint16 NoMimeType    = 0xffff;
+
+enum SnapshotFlag {
+    SymLinkFlag    = 0x01,
+    ReadableFlag   = 0x02,
+    WritableFlag   = 0x04,
+    ExecutableFlag = 0x08
+};
+
+struct SnapshotHeader {
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    quint32 pathLength;       //!< in QChar units
+    quint32 namesLength;      //!< in QChar units
+    quint32 mimeCount;        //!< different mime type names
+    quint32 mimeNamesLength;  //!< in QChar units
+    quint32 reserved;
+    qint64  dirModified;      //!< msecs since epoch
+};
+
+/*!
+ * \brief The SnapshotLayout struct computes the offset of each column for a number of items
+ */
+struct SnapshotLayout {
+    explicit SnapshotLayout(const SnapshotHeader &header)
+    {
+        const qint64 count = header.count;
+        sizes           = sizeof(SnapshotHeader);
+        mtimes          = sizes           + count * sizeof(qint64);
+        ctimes          = mtimes          + count * sizeof(qint64);
+        atimes          = ctimes          + count * sizeof(qint64);
+        modes           = atimes          + count * sizeof(qint64);
+        uids            = modes           + count * sizeof(quint32);
+        gids            = uids            + count * sizeof(quint32);
+        nameOffsets     = gids            + count * sizeof(quint32);
+        mimeNameOffsets = nameOffsets     + (count + 1) * sizeof(quint32);
+        mimes           = mimeNameOffsets + (qint64(header.mimeCount) + 1) * sizeof(quint32);
+        flags           = mimes           + count * sizeof(quint16);
+        path            = flags           + count * sizeof(quint8);
+        path            = (path + 1) & ~qint64(1);  // QChar alignment
+        names           = path            + qint64(header.pathLength) * sizeof(QChar);
+        mimeNames       = names           + qint64(header.namesLength) * sizeof(QChar);
+        total           = mimeNames       + qint64(header.mimeNamesLength) * sizeof(QChar);
+    }
+    qint64 sizes, mtimes, ctimes, atimes, modes, uids, gids, nameOffsets, mimeNameOffsets, mimes, flags;
+    qint64 path, names, mimeNames, total;
+};
+
+template <typename T>
+inline void appendColumn(QByteArray &data, const QVector<T> &column)
+{
+    data.append(reinterpret_cast<const char *> (column.constData()), column.count() * int(sizeof(T)));
+}
+
+inline qint64 toMSecs(const QDateTime &time)
+{
+    return time.isValid() ? time.toMSecsSinceEpoch() : 0;
+}
+
+inline struct timespec toTimeSpec(qint64 msecs)
+{
+    struct timespec time;
+    time.tv_sec  = msecs / 1000;
+    time.tv_nsec = (msecs % 1000) * 1000000;
+    return time;
+}
+
+/*!
+ * \brief modeOf() rebuilds the st_mode bits that \ref DirItemInfo::setLocalFileFromStatBuf() uses
+ */
+quint32 modeOf(const DirItemInfo &item)
+{
+    static const struct {
+        QFile::Permission permission;
+        mode_t            bit;
+    } permissionBits[] = {
+        { QFile::ReadOwner, S_IRUSR }, { QFile::WriteOwner, S_IWUSR }, { QFile::ExeOwner, S_IXUSR },
+        { QFile::ReadGroup, S_IRGRP }, { QFile::WriteGroup, S_IWGRP }, { QFile::ExeGroup, S_IXGRP },
+        { QFile::ReadOther, S_IROTH }, { QFile::WriteOther, S_IWOTH }, { QFile::ExeOther, S_IXOTH }
+    };
+    const QFile::Permissions permissions = item.permissions();
+    quint32 mode = item.isDir() ? S_IFDIR : S_IFREG;
+    for (uint counter = 0; counter < sizeof(permissionBits) / sizeof(permissionBits[0]); ++counter) {
+        if (permissions & permissionBits[counter].permission) {
+            mode |= permissionBits[counter].bit;
+        }
+    }
+    return mode;
+}
+
+} // namespace
+
+
+/*!
+ * \brief DirListingSnapshot::write() saves \a items as the listing of \a dirPath into \a fileName
+ *
+ *  The file is replaced atomically, a reader never sees a partial file.
+ */
+bool DirListingSnapshot::write(const QString &fileName, const QString &dirPath,
+                               const QDateTime &dirModified, const DirItemInfoList &items)
+{
+    const quint32 count = items.count();
+    QVector<qint64>  sizes(count), mtimes(count), ctimes(count), atimes(count);
+    QVector<quint32> modes(count), uids(count), gids(count), nameOffsets(count + 1);
+    QVector<quint32> mimeNameOffsets;
+    QVector<quint16> mimes(count, NoMimeType);
+    QVector<quint8>  flags(count);
+    QString          names;
+    QString          mimeNames;
+    QHash<QString, quint16> mimeIndexes;
+
+    for (quint32 counter = 0; counter < count; ++counter) {
+        DirItemInfo item(items.at(counter));
+        nameOffsets[counter] = names.size();
+        // an item of a lazy listing may not be stat'ed yet, the copy is stat'ed in this IO thread
+        if (item.needsStat() && !item.resolvePendingStat()) {
+            continue; // an empty name means the item no longer exists
+        }
+        sizes[counter]       = item.size();
+        mtimes[counter]      = toMSecs(item.lastModified());
+        ctimes[counter]      = toMSecs(item.created());
+        atimes[counter]      = toMSecs(item.lastRead());
+        modes[counter]       = modeOf(item);
+        uids[counter]        = item.ownerId();
+        gids[counter]        = item.groupId();
+        flags[counter]       = (item.isSymLink()    ? SymLinkFlag    : 0)
+                               | (item.isReadable()   ? ReadableFlag   : 0)
+                               | (item.isWritable()   ? WritableFlag   : 0)
+                               | (item.isExecutable() ? ExecutableFlag : 0);
+        names               += item.fileName();
+        // a type that still needs the content is found again after reading the snapshot
+        if (!item.needsMimeTypeFromContent()) {
+            const QString mimeName = item.mimeType().name();
+            QHash<QString, quint16>::const_iterator found = mimeIndexes.constFind(mimeName);
+            if (found != mimeIndexes.constEnd()) {
+                mimes[counter] = found.value();
+            } else if (mimeIndexes.count() < NoMimeType) {
+                mimes[counter] = mimeIndexes.count();
+                mimeIndexes.insert(mimeName, mimes[counter]);
+                mimeNameOffsets.append(mimeNames.size());
+                mimeNames += mimeName;
+            }
+        }
+    }
+    nameOffsets[count] = names.size();
+    mimeNameOffsets.append(mimeNames.size());
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic           = SnapshotMagic;
+    header.version         = DIRLIST_SNAPSHOT_VERSION;
+    header.count           = count;
+    header.pathLength      = dirPath.size();
+    header.namesLength     = names.size();
+    header.mimeCount       = mimeIndexes.count();
+    header.mimeNamesLength = mimeNames.size();
+    header.dirModified     = dirModified.toMSecsSinceEpoch();
+
+    const SnapshotLayout layout(header);
+    QByteArray data;
+    data.reserve(layout.total);
+    data.append(reinterpret_cast<const char *> (&header), sizeof(header));
+    appendColumn(data, sizes);
+    appendColumn(data, mtimes);
+    appendColumn(data, ctimes);
+    appendColumn(data, atimes);
+    appendColumn(data, modes);
+    appendColumn(data, uids);
+    appendColumn(data, gids);
+    appendColumn(data, nameOffsets);
+    appendColumn(data, mimeNameOffsets);
+    appendColumn(data, mimes);
+    appendColumn(data, flags);
+    if (data.size() < layout.path) {
+        data.append('\0');
+    }
+    data.append(reinterpret_cast<const char *> (dirPath.constData()), dirPath.size() * int(sizeof(QChar)));
+    data.append(reinterpret_cast<const char *> (names.constData()), names.size() * int(sizeof(QChar)));
+    data.append(reinterpret_cast<const char *> (mimeNames.constData()), mimeNames.size() * int(sizeof(QChar)));
+    Q_ASSERT(data.size() == layout.total);
+
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QFile::WriteOnly) || file.write(data) != data.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+/*!
+ * \brief DirListingSnapshot::read() maps \a fileName and creates the items of \a dirPath
+ * \param dirModified the current modification time of the directory, it is checked before any item is created
+ * \return false if the file does not exist, it is not valid, it belongs to another directory
+ *         or the directory changed since the snapshot was taken
+ */
+bool DirListingSnapshot::read(const QString &fileName, const QString &dirPath,
+                              const QDateTime &dirModified, DirItemInfoList &items)
+{
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly) || file.size() < qint64(sizeof(SnapshotHeader))) {
+        return false;
+    }
+    const uchar *data = file.map(0, file.size());
+    if (data == 0) {
+        return false;
+    }
+
+    bool ret = false;
+    const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader *> (data);
+    if (header->magic == SnapshotMagic && header->version == DIRLIST_SNAPSHOT_VERSION
+            && dirModified.isValid() && header->dirModified == dirModified.toMSecsSinceEpoch()) {
+        const SnapshotLayout layout(*header);
+        const QChar *path = reinterpret_cast<const QChar *> (data + layout.path);
+        if (layout.total == file.size()
+                && QString::fromRawData(path, header->pathLength) == dirPath) {
+            const qint64  *sizes       = reinterpret_cast<const qint64 *>  (data + layout.sizes);
+            const qint64  *mtimes      = reinterpret_cast<const qint64 *>  (data + layout.mtimes);
+            const qint64  *ctimes      = reinterpret_cast<const qint64 *>  (data + layout.ctimes);
+            const qint64  *atimes      = reinterpret_cast<const qint64 *>  (data + layout.atimes);
+            const quint32 *modes       = reinterpret_cast<const quint32 *> (data + layout.modes);
+            const quint32 *uids        = reinterpret_cast<const quint32 *> (data + layout.uids);
+            const quint32 *gids        = reinterpret_cast<const quint32 *> (data + layout.gids);
+            const quint32 *nameOffsets = reinterpret_cast<const quint32 *> (data + layout.nameOffsets);
+            const quint32 *mimeOffsets = reinterpret_cast<const quint32 *> (data + layout.mimeNameOffsets);
+            const quint16 *mimes       = reinterpret_cast<const quint16 *> (data + layout.mimes);
+            const quint8  *flags       = reinterpret_cast<const quint8 *>  (data + layout.flags);
+            const QChar   *names       = reinterpret_cast<const QChar *>   (data + layout.names);
+            const QChar   *mimeNames   = reinterpret_cast<const QChar *>   (data + layout.mimeNames);
+
+            // each type is looked up once, an unknown name leaves the type to be found again
+            QVector<QMimeType> mimeTypes(header->mimeCount);
+            QMimeDatabase      mimeDatabase;
+            ret = mimeOffsets[header->mimeCount] == header->mimeNamesLength;
+            for (quint32 counter = 0; ret && counter < header->mimeCount; ++counter) {
+                const quint32 nameStart = mimeOffsets[counter];
+                const quint32 nameEnd   = mimeOffsets[counter + 1];
+                ret = nameStart <= nameEnd && nameEnd <= header->mimeNamesLength;
+                if (ret) {
+                    mimeTypes[counter] = mimeDatabase.mimeTypeForName(
+                                             QString::fromRawData(mimeNames + nameStart, nameEnd - nameStart));
+                }
+            }
+
+            items.clear();
+            items.reserve(header->count);
+            ret = ret && nameOffsets[header->count] == header->namesLength;
+            for (quint32 counter = 0; ret && counter < header->count; ++counter) {
+                const quint32 nameStart = nameOffsets[counter];
+                const quint32 nameEnd   = nameOffsets[counter + 1];
+                if (nameStart > nameEnd || nameEnd > header->namesLength) {
+                    ret = false;
+                    break;
+                }
+                if (nameStart == nameEnd) { // item no longer existed when the snapshot was written
+                    continue;
+                }
+                struct stat st;
+                memset(&st, 0, sizeof(st));
+                st.st_size  = sizes[counter];
+                st.st_mtim  = toTimeSpec(mtimes[counter]);
+                st.st_ctim  = toTimeSpec(ctimes[counter]);
+                st.st_atim  = toTimeSpec(atimes[counter]);
+                st.st_mode  = modes[counter];
+                st.st_uid   = uids[counter];
+                st.st_gid   = gids[counter];
+                DirItemInfo item;
+                item.setLocalFileFromStatBuf(dirPath, QString(names + nameStart, nameEnd - nameStart),
+                                             st, flags[counter] & SymLinkFlag,
+                                             ((flags[counter] & ReadableFlag)   ? R_OK : 0)
+                                             | ((flags[counter] & WritableFlag)   ? W_OK : 0)
+                                             | ((flags[counter] & ExecutableFlag) ? X_OK : 0));
+                if (mimes[counter] < header->mimeCount && mimeTypes.at(mimes[counter]).isValid()) {
+                    item.setMimeType(mimeTypes.at(mimes[counter]));
+                }
+                // the items go to the model rows as they are, see IORequestLoader::prepareBatch()
+                item.resolveMimeTypeFromName();
+                items.append(item);
+            }
+            if (!ret) {
+                items.clear();
+            }
+        }
+    }
+    file.unmap(const_cast<uchar *> (data));
+    return ret;
+}
+
+/*!
+ * \brief DirListingSnapshot::removeOldFiles() keeps only the \a maxFiles most recent snapshots
+ */
+void DirListingSnapshot::removeOldFiles(const QString &snapshotsDir, int maxFiles)
+{
+    QDir dir(snapshotsDir);
+    QFileInfoList files = dir.entryInfoList(QDir::Files, QDir::Time);
+    for (int counter = maxFiles; counter < files.count(); ++counter) {
+        QFile::remove(files.at(counter).absoluteFilePath());
+    }
+}
+
+
+DirListingSnapshotWriter::DirListingSnapshotWriter(const QString &fileName, const QString &dirPath,
+                                                   const QDateTime &dirModified,
+                                                   const DirItemInfoList &items)
+    : IORequest()
+    , m_fileName(fileName)
+    , m_dirPath(dirPath)
+    , m_dirModified(dirModified)
+    , m_items(items)
+{
+    m_type     = ListingSnapshotSave;
+    m_priority = PrefetchPriority;
+}
+
+void DirListingSnapshotWriter::run()
+{
+    if (DirListingSnapshot::write(m_fileName, m_dirPath, m_dirModified, m_items)) {
+        DirListingSnapshot::removeOldFiles(QFileInfo(m_fileName).absolutePath());
+    } else {
+        qWarning() << Q_FUNC_INFO << "could not save listing snapshot" << m_fileName;
+    }
+}
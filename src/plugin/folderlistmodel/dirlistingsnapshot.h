@@ -0,0 +1,98 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: dirlistingsnapshot.h
+ * Date: 17/10/2026
+ */
+
+#ifndef DIRLISTINGSNAPSHOT_H
+#define DIRLISTINGSNAPSHOT_H
+
+#include "iorequest.h"
+#include "diriteminfo.h"
+
+#include <QDateTime>
+#include <QString>
+
+/*!
+ *  Format version of the snapshot files, files with other versions are ignored
+ */
+#define DIRLIST_SNAPSHOT_VERSION     4
+
+/*!
+ *  Maximum number of snapshot files kept on disk, the oldest are removed
+ */
+#define DIRLIST_SNAPSHOT_MAX_FILES   32
+
+/*!
+ * \brief The DirListingSnapshot class reads and writes local directory listings to disk
+ *
+ *  A snapshot lets \ref DirModel show a folder on the first frame after the application
+ *  starts, the listing is then compared with the disk in background.
+ *
+ *  The file is memory mapped when read, its layout is columnar so each column is a plain array:
+ *  \code
+ *     header        magic, version, count, directory modification time, string lengths
+ *     qint64        size[count]
+ *     qint64        mtime[count]      msecs since epoch
+ *     qint64        ctime[count]
+ *     qint64        atime[count]
+ *     quint32       mode[count]       st_mode
+ *     quint32       uid[count]
+ *     quint32       gid[count]
+ *     quint32       nameOffset[count + 1]
+ *     quint32       mimeNameOffset[mimeCount + 1]
+ *     quint16       mime[count]       index of the mime type name, 0xffff when it was not known yet
+ *     quint8        flags[count]      1 = symbolic link, 2/4/8 = readable/writable/executable by the user
+ *     QChar         path[pathLength]  the directory, checked when the file is read
+ *     QChar         names[namesLength]
+ *     QChar         mimeNames[mimeNamesLength]
+ *  \endcode
+ *
+ *  Everything comes from the items, the disk is read only for items of a lazy listing not stat'ed yet.
+ *
+ *  Files are a private cache of the machine, they use the native byte order.
+ */
+class DirListingSnapshot
+{
+public:
+    static bool    write(const QString &fileName, const QString &dirPath,
+                         const QDateTime &dirModified, const DirItemInfoList &items);
+    static bool    read(const QString &fileName, const QString &dirPath,
+                        const QDateTime &dirModified, DirItemInfoList &items);
+    static void    removeOldFiles(const QString &snapshotsDir, int maxFiles = DIRLIST_SNAPSHOT_MAX_FILES);
+};
+
+
+/*!
+ * \brief The DirListingSnapshotWriter class saves a \ref DirListingSnapshot in an IO thread
+ */
+class DirListingSnapshotWriter : public IORequest
+{
+    Q_OBJECT
+public:
+    DirListingSnapshotWriter(const QString &fileName, const QString &dirPath,
+                             const QDateTime &dirModified, const DirItemInfoList &items);
+    void run();
+
+private:
+    QString          m_fileName;
+    QString          m_dirPath;
+    QDateTime        m_dirModified;
+    DirItemInfoList  m_items;
+};
+
+#endif // DIRLISTINGSNAPSHOT_H
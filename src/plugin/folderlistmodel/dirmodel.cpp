@@ -41,15 +41,16 @@
 #include "trashlocation.h"
 #include "netauthenticationdata.h"
 #include "locationitemdir.h"
+#include "dirlistingcache.h"
+#include "dirchildcounter.h"
+#include "mimetyperesolver.h"
+#include "itemstatresolver.h"
+#include "ioscheduler.h"
+#include "ioworkerthread.h"
 
 
 #ifndef DO_NOT_USE_TAG_LIB
-#include <taglib/attachedpictureframe.h>
-#include <taglib/id3v2tag.h>
-#include <taglib/fileref.h>
-#include <taglib/mpegfile.h>
-#include <taglib/tag.h>
-#include <taglib/audioproperties.h>
+#include "audiometadata.h"
 #endif
 
 #include <errno.h>
@@ -81,10 +82,28 @@
 
 #define IS_FILE_MANAGER_IDLE()            (!mAwaitingResults)
 
+/*!
+ *  When a batch of items goes into more places than this, the items are appended and moved
+ *  by a single layout change instead of sending one rowsInserted() for each place,
+ *  see \ref DirModel::insertSortedItems()
+ */
+#define MAX_INSERT_RANGES_PER_BATCH       64
+
 #define IS_BROWSING_TRASH_ROOTDIR() (mCurLocation && mCurLocation->isTrashDisk() && mCurLocation->isRoot())
 
 namespace {
 QHash<QByteArray, int> roleMapping;
+QList<DirModel *> allModels;   //!< the natural sort mode is global, all models reorder their items
+
+bool pathLessThan(const DirItemInfo &a, const DirItemInfo &b)
+{
+    return a.absoluteFilePath() < b.absoluteFilePath();
+}
+
+bool itemPathLessThan(const DirItemInfo &item, const QString &absoluteFilePath)
+{
+    return item.absoluteFilePath() < absoluteFilePath;
+}
 }
 
 /*!
@@ -108,6 +127,8 @@ DirModel::DirModel(QObject *parent)
     , mAwaitingResults(false)
     , mIsRecursive(false)
     , mReadsMediaMetadata(false)
+    , mLazyMetadata(false)
+    , mListingIsLazy(false)
     , mQmlCompleted(false)
     , mShowHiddenFiles(false)
     , mOnlyAllowedPaths(false)
@@ -121,11 +142,29 @@ DirModel::DirModel(QObject *parent)
     , mLocationFactory(new LocationsFactory(this))
     , mCurLocation(0)
     , m_fsAction(new FileSystemAction(mLocationFactory, this) )
+    , mFetchPageSize(0)
+    , mPendingFirst(0)
+    , mPendingSorted(true)
+    , mDiffRefresh(false)
+    , mListingSorted(true)
+    , mPendingIndex(&mPendingContents)
+    , mRowIndex(&mDirectoryContents)
 {
     mNameFilters = QStringList() << "*";
+    mNameFilterMatcher.setPatterns(mNameFilters);
 
     mSelection = new DirSelection(this, &mDirectoryContents);
 
+    // keep the path index of rowOfItem() up to date
+    connect(this, &DirModel::rowsInserted, this, [this](const QModelIndex &, int first, int last) {
+        mRowIndex.rowsInserted(first, last - first + 1);
+    });
+    connect(this, &DirModel::rowsAboutToBeRemoved, this, [this](const QModelIndex &, int first, int last) {
+        mRowIndex.rowsAboutToBeRemoved(first, last - first + 1);
+    });
+    connect(this, &DirModel::modelReset,    this, [this]() { mRowIndex.invalidate(); });
+    connect(this, &DirModel::layoutChanged, this, [this]() { mRowIndex.invalidate(); });
+
     connect(m_fsAction, SIGNAL(progress(int, int, int)),
             this,       SIGNAL(progress(int, int, int)));
 
@@ -161,6 +200,7 @@ DirModel::DirModel(QObject *parent)
     connect(this, &DirModel::rowsRemoved, this, &DirModel::countChanged);
 
     setCompareAndReorder();
+    allModels.append(this);
 
     if (QIcon::themeName().isEmpty() && !FMUtil::hasTriedThemeName()) {
         FMUtil::setThemeName();
@@ -173,14 +213,8 @@ DirModel::DirModel(QObject *parent)
         connect(l,     SIGNAL(itemsFetched()),
                 this,  SLOT(onItemsFetched()));
 
-        connect(l,     SIGNAL(extWatcherItemAdded(DirItemInfo)),
-                this,  SLOT(onItemAddedOutsideFm(DirItemInfo)));
-
-        connect(l,     SIGNAL(extWatcherItemRemoved(DirItemInfo)),
-                this,  SLOT(onItemRemovedOutSideFm(DirItemInfo)));
-
-        connect(l,     SIGNAL(extWatcherItemChanged(DirItemInfo)),
-                this,  SLOT(onItemChangedOutSideFm(DirItemInfo)));
+        connect(l,     SIGNAL(extWatcherChangesFound(DirItemChangeSet)),
+                this,  SLOT(onItemsChangedOutsideFm(DirItemChangeSet)));
 
         connect(l,     SIGNAL(extWatcherChangesFetched(int)),
                 this,  SLOT(onExternalFsWorkerFinished(int)));
@@ -188,6 +222,9 @@ DirModel::DirModel(QObject *parent)
         connect(l,     SIGNAL(extWatcherPathChanged(QString)),
                 this,  SLOT(onThereAreExternalChanges(QString)));
 
+        connect(l,     SIGNAL(extWatcherEntriesChanged(QString, QStringList)),
+                this,  SLOT(onThereAreExternalEntryChanges(QString, QStringList)));
+
         connect(l,      SIGNAL(needsAuthentication(QString, QString)),
                 this,   SIGNAL(needsAuthentication(QString, QString)), Qt::QueuedConnection);
 
@@ -200,6 +237,7 @@ DirModel::DirModel(QObject *parent)
 
 DirModel::~DirModel()
 {
+    allModels.removeOne(this);
     // release global Authentication Data
     NetAuthenticationDataList::releaseInstance(this);
 }
@@ -315,7 +353,7 @@ QVariant DirModel::data(const QModelIndex &index, int role) const
         return icon;
     }
     if (role == Qt::BackgroundRole && index.column() == 0) {
-        if (mDirectoryContents.at(index.row()).isSelected()) {
+        if (mSelection->isIndexSelected(index.row())) {
             //TODO it'd better to get some style or other default
             //     background color
             return QBrush(Qt::lightGray);
@@ -341,6 +379,11 @@ QVariant DirModel::data(const QModelIndex &index, int role) const
 
     const DirItemInfo &fi = mDirectoryContents.at(index.row());
 
+    // a lazy listing has only names and types, the row is stat'ed now that it is shown
+    if (fi.needsStat()) {
+        queueItemStat(fi);
+    }
+
     switch (role) {
     case FileNameRole:
         return fi.fileName();
@@ -353,12 +396,15 @@ QVariant DirModel::data(const QModelIndex &index, int role) const
     case FileSizeRole: {
         if (fi.isBrowsable()) {
             if (fi.isLocal()) {
-                return dirItems(fi.diskFileInfo());
+                return dirItems(fi);
             }
             //it is possible to browse network folders and get its
             //number of items, but it may take longer
             return tr("Unknown");
         }
+        if (fi.needsStat()) {
+            return QString();
+        }
         return fileSize(fi.size());
     }
     case IconSourceRole: {
@@ -387,14 +433,15 @@ QVariant DirModel::data(const QModelIndex &index, int role) const
         return fi.isDir();
     case IsFileRole:
         return !fi.isBrowsable();
+    // permissions of a lazy listing item are unknown until it is stat'ed, not denied
     case IsReadableRole:
-        return fi.isReadable();
+        return fi.needsStat() ? QVariant() : QVariant(fi.isReadable());
     case IsWritableRole:
-        return fi.isWritable();
+        return fi.needsStat() ? QVariant() : QVariant(fi.isWritable());
     case IsExecutableRole:
-        return fi.isExecutable();
+        return fi.needsStat() ? QVariant() : QVariant(fi.isExecutable());
     case IsSelectedRole:
-        return fi.isSelected();
+        return mSelection->isIndexSelected(index.row());
     case IsHostRole:
         return fi.isHost();
     case IsRemoteRole:
@@ -410,6 +457,9 @@ QVariant DirModel::data(const QModelIndex &index, int role) const
     case IsBrowsableRole:
         return fi.isBrowsable();
     case IsSharingAllowedRole:
+        if (fi.needsStat()) {
+            return QVariant();
+        }
         return     fi.isDir() && !fi.isSymLink() && !fi.isSharedDir()
                    && mCurLocation->isLocalDisk()
                    && fi.isWritable() && fi.isExecutable() && fi.isReadable();
@@ -424,8 +474,9 @@ QVariant DirModel::data(const QModelIndex &index, int role) const
     case TrackGenreRole:
     case TrackLengthRole:
     case TrackCoverRole:
-        if (mReadsMediaMetadata && fi.isLocal()) {
-            return getAudioMetaData(fi.diskFileInfo(), role);
+        // the tags cache is keyed by size and date, they come with the stat()
+        if (mReadsMediaMetadata && fi.isLocal() && !fi.needsStat()) {
+            return getAudioMetaData(fi, role);
         }
         break;
 #endif
@@ -468,14 +519,6 @@ void DirModel::setPath(const QString &pathName, const QString &user, const QStri
         return;
     }
 
-    if (mAwaitingResults) {
-        // TODO: handle the case where pathName != our current path, cancel old
-        // request, start a new one
-        qDebug() << Q_FUNC_INFO << this << "Ignoring path change request, request already running in" <<
-                 pathName;
-        return;
-    }
-
     Location *location = mLocationFactory->setNewPath(pathName, user, password, savePassword);
     if (location == 0) {
         // perhaps a goBack() operation to a folder/location that was removed,
@@ -490,10 +533,24 @@ void DirModel::setPath(const QString &pathName, const QString &user, const QStri
         return;
     }
 
-    mCurLocation = location;
+    setCurrentLocation(location);
     setPathFromCurrentLocation();
 }
 
+/*!
+ * \brief DirModel::setCurrentLocation() sets \a location as the current, cancelling a fetch of the previous one
+ *
+ *  When the location does not change the fetch is cancelled by \ref Location::fetchItems()
+ */
+void DirModel::setCurrentLocation(Location *location)
+{
+    // it also cancels a background compare started by fillFromListingCache()
+    if (mCurLocation && mCurLocation != location) {
+        mCurLocation->cancelFetch();
+    }
+    mCurLocation = location;
+}
+
 /*!
  * \brief DirModel::setPathFromCurrentLocation() changes current Path using current Location
  *
@@ -501,17 +558,45 @@ void DirModel::setPath(const QString &pathName, const QString &user, const QStri
  */
 void DirModel::setPathFromCurrentLocation()
 {
-    mAwaitingResults = true;
-    emit awaitingResultsChanged();
-
 #if DEBUG_MESSAGES
     qDebug() << Q_FUNC_INFO << this << "Changing to " << mCurLocation->urlPath();
 #endif
 
-    clear();
+    IORequest::Priority priority = mCurrentDir == mCurLocation->urlPath() ?
+                                   IORequest::RefreshPriority : IORequest::NavigationPriority;
+    if (priority == IORequest::NavigationPriority) {
+        // leaving mCurrentDir, the snapshot also keeps changes made after it was loaded
+        mSelection->clear();
+        storeListingSnapshot();
+    }
+
+    // refreshing rows already shown applies only the differences, see applyRefreshedContents()
+    const bool diffRefresh = priority == IORequest::RefreshPriority && !mDirectoryContents.isEmpty();
+    if (diffRefresh) {
+        mRefreshedContents.clear();
+        mAddedWhileRefreshing.clear();
+    } else {
+        clear();
+    }
+    mDiffRefresh = diffRefresh;
 
-    mCurrentDir = mCurLocation->urlPath();
-    mCurLocation->fetchItems(currentDirFilter(), mIsRecursive);
+    mCurrentDir          = mCurLocation->urlPath();
+    mListingCacheKey     = listingCacheKey();
+    mCurrentDirModified  = mCurLocation->info()->lastModified();
+
+    // a refresh always reads the directory again
+    if (priority == IORequest::RefreshPriority || !fillFromListingCache()) {
+        if (!mAwaitingResults) {
+            mAwaitingResults = true;
+            emit awaitingResultsChanged();
+        }
+        // sorting by size or date needs all of them, see setCompareAndReorder()
+        // comparing with the current rows also needs them
+        mListingIsLazy = mLazyMetadata && mSortBy == SortByName && !diffRefresh;
+        mCurLocation->setSortFunction(mCompareFunction);
+        mCurLocation->setLazyStat(mListingIsLazy);
+        mCurLocation->fetchItems(listingDirFilter(), mIsRecursive, priority);
+    }
 
     if (mPathList.count() == 0 || mPathList.last() != mCurrentDir) {
         mPathList.append(mCurrentDir);
@@ -528,7 +613,7 @@ bool DirModel::canGoBack() const
 
 void DirModel::goBack()
 {
-    if (mPathList.count() > 1 && !mAwaitingResults) {
+    if (mPathList.count() > 1) {
         mPathList.removeLast();
 
 #if DEBUG_MESSAGES
@@ -545,9 +630,460 @@ void DirModel::onItemsFetched()
         qDebug() << Q_FUNC_INFO << this << "No longer awaiting results";
 #endif
 
+        mAwaitingResults = false;
+        if (mDiffRefresh) {
+            applyRefreshedContents();
+        }
+        emit awaitingResultsChanged();
+        storeListingSnapshot();
+        requestMimeTypesFromContent();
+        replayExternalChanges();
+    }
+}
+
+/*!
+ * \brief DirModel::applyRefreshedContents() turns the current rows into the listing read by a refresh
+ *
+ *  An unchanged directory does not touch the model at all, see \ref applyContents().
+ */
+void DirModel::applyRefreshedContents()
+{
+    mDiffRefresh = false;
+    mListing.swap(mRefreshedContents);
+    mListingSorted = false;
+    mRefreshedContents.clear();
+    // the directory may have been read before they were created
+    appendToListing(mAddedWhileRefreshing);
+    mAddedWhileRefreshing.clear();
+    sortListing();
+
+    DirItemInfoList items;
+    items.reserve(mListing.count());
+    for (int counter = 0; counter < mListing.count(); ++counter) {
+        if (acceptsItem(mListing.at(counter))) {
+            items.append(mListing.at(counter));
+        }
+    }
+    applyContents(items);
+}
+
+/*!
+ * \brief DirModel::applyFilters() shows the items of \a mListing that pass the current filters
+ *
+ *  Non recursive listings keep hidden files and directories, so filters change rows without
+ *  reading the directory again. A recursive listing depends on the filters and is read again.
+ *
+ * \param childCountsChanged true when the filter used to count directory items changed
+ */
+void DirModel::applyFilters(bool childCountsChanged)
+{
+    if (mIsRecursive) {
+        refresh();
+        return;
+    }
+    if (childCountsChanged) {
+        mChildCounts.clear();
+        mChildCountsQueue.clear();
+    }
+    // a refresh in progress applies the filters when it is complete
+    if (mDiffRefresh) {
+        return;
+    }
+
+    sortListing();
+    DirItemInfoList items;
+    items.reserve(mListing.count());
+    for (int counter = 0; counter < mListing.count(); ++counter) {
+        if (acceptsItem(mListing.at(counter))) {
+            items.append(mListing.at(counter));
+        }
+    }
+    applyContents(items);
+
+    if (childCountsChanged && rowCount() > 0) {
+        emit dataChanged(index(0, 0), index(rowCount() - 1, 0));
+    }
+    if (!mAwaitingResults) {
+        requestMimeTypesFromContent();
+    }
+}
+
+/*!
+ * \brief DirModel::acceptsItem() returns true when \a fi passes hidden files, directories and name filters
+ */
+bool DirModel::acceptsItem(const DirItemInfo &fi) const
+{
+    // an empty filter list hides everything, even directories
+    if (mNameFilters.isEmpty()) {
+        return false;
+    }
+    if (!mShowHiddenFiles && fi.fileName().startsWith(QLatin1Char('.'))) {
+        return false;
+    }
+    if (fi.isDir()) {
+        return mShowDirectories && (!mFilterDirectories || mNameFilterMatcher.matches(fi.fileName()));
+    }
+    return mNameFilterMatcher.matches(fi.fileName());
+}
+
+/*!
+ * \brief DirModel::listingContents() returns every item read for the current path, filtered or not
+ */
+DirItemInfoList DirModel::listingContents()
+{
+    sortListing();
+    return mListing;
+}
+
+/*!
+ * \brief DirModel::listingIndexOf() returns the index of \a absoluteFilePath in \ref mListing, -1 if it is not there
+ */
+int DirModel::listingIndexOf(const QString &absoluteFilePath)
+{
+    sortListing();
+    DirItemInfoList::ConstIterator it = std::lower_bound(mListing.constBegin(), mListing.constEnd(),
+                                                         absoluteFilePath, itemPathLessThan);
+    if (it == mListing.constEnd() || it->absoluteFilePath() != absoluteFilePath) {
+        return -1;
+    }
+    return it - mListing.constBegin();
+}
+
+/*!
+ * \brief DirModel::insertIntoListing() inserts \a fi into \ref mListing, an item of the same path is replaced
+ */
+void DirModel::insertIntoListing(const DirItemInfo &fi)
+{
+    sortListing();
+    DirItemInfoList::Iterator it = std::lower_bound(mListing.begin(), mListing.end(),
+                                                    fi.absoluteFilePath(), itemPathLessThan);
+    if (it != mListing.end() && it->absoluteFilePath() == fi.absoluteFilePath()) {
+        DirItemInfo copy(fi);
+        it->swap(copy);
+    } else {
+        mListing.insert(it, fi);
+    }
+}
+
+/*!
+ * \brief DirModel::removeFromListing() removes the item of \a absoluteFilePath from \ref mListing
+ */
+void DirModel::removeFromListing(const QString &absoluteFilePath)
+{
+    const int index = listingIndexOf(absoluteFilePath);
+    if (index >= 0) {
+        mListing.remove(index);
+    }
+}
+
+/*!
+ * \brief DirModel::appendToListing() appends a batch of \a items to \ref mListing
+ *
+ *  Batches come sorted by the model order, not by path, so they are appended as they come and
+ *  \ref mListing is sorted once when it is looked up, see \ref sortListing().
+ */
+void DirModel::appendToListing(const DirItemInfoList &items)
+{
+    for (int counter = 0; counter < items.count(); ++counter) {
+        if (mListingSorted && !mListing.isEmpty() && !pathLessThan(mListing.last(), items.at(counter))) {
+            mListingSorted = false;
+        }
+        mListing.append(items.at(counter));
+    }
+}
+
+/*!
+ * \brief DirModel::sortListing() sorts \ref mListing by path after items were appended out of order
+ *
+ *  A path appended twice keeps the item appended last.
+ */
+void DirModel::sortListing()
+{
+    if (mListingSorted) {
+        return;
+    }
+    std::stable_sort(mListing.begin(), mListing.end(), pathLessThan);
+    int kept = 0;
+    for (int counter = 0; counter < mListing.count(); ++counter) {
+        if (counter + 1 < mListing.count()
+                && mListing.at(counter + 1).absoluteFilePath() == mListing.at(counter).absoluteFilePath()) {
+            continue;
+        }
+        if (kept != counter) {
+            DirItemInfo copy(mListing.at(counter));
+            mListing[kept].swap(copy);
+        }
+        ++kept;
+    }
+    mListing.resize(kept);
+    mListingSorted = true;
+}
+
+/*!
+ * \brief DirModel::applyContents() turns the current rows into \a items
+ *
+ *  Rows no longer listed are removed, rows whose size, date or permissions changed get dataChanged()
+ *  and new items are merged by \ref insertSortedItems(), so unchanged items do not touch the model.
+ *  A row whose position in the sort order changed is removed and inserted again.
+ */
+void DirModel::applyContents(DirItemInfoList items)
+{
+    sortItems(items, mCompareFunction);
+
+    // when paging the same number of rows stay exposed
+    mPendingContents.clear();
+    mPendingFirst  = 0;
+    mPendingSorted = true;
+    mPendingIndex.invalidate();
+    if (mFetchPageSize > 0) {
+        const int exposed = qMax(mDirectoryContents.count(), mFetchPageSize);
+        if (exposed < items.count()) {
+            mPendingContents = items.mid(exposed);
+            items.resize(exposed);
+        }
+    }
+
+    QHash<QString, int> newIndexes;
+    newIndexes.reserve(items.count());
+    for (int counter = 0; counter < items.count(); ++counter) {
+        newIndexes.insert(items.at(counter).absoluteFilePath(), counter);
+    }
+
+    // rows that keep their place are the longest run of rows whose new indexes grow as the rows do,
+    // found by patience sorting: tails[k] is the row ending the best run of length k + 1
+    const int rows = mDirectoryContents.count();
+    QVector<int> newIndexOfRow(rows, -1);
+    QVector<int> previousRow(rows, -1);
+    QVector<int> tails;
+    for (int row = 0; row < rows; ++row) {
+        const int index = newIndexes.value(mDirectoryContents.at(row).absoluteFilePath(), -1);
+        newIndexOfRow[row] = index;
+        if (index < 0) {
+            continue;
+        }
+        int low = 0;
+        int high = tails.count();
+        while (low < high) {
+            const int middle = (low + high) / 2;
+            if (newIndexOfRow.at(tails.at(middle)) < index) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        previousRow[row] = low > 0 ? tails.at(low - 1) : -1;
+        if (low == tails.count()) {
+            tails.append(row);
+        } else {
+            tails[low] = row;
+        }
+    }
+
+    QVector<int> keptIndexes(rows, -1);
+    QVector<bool> isNew(items.count(), true);
+    for (int row = tails.isEmpty() ? -1 : tails.last(); row >= 0; row = previousRow.at(row)) {
+        keptIndexes[row] = newIndexOfRow.at(row);
+        isNew[newIndexOfRow.at(row)] = false;
+    }
+    int removeRanges = 0;
+    for (int row = 0; row < rows; ++row) {
+        if (keptIndexes.at(row) < 0 && (row == 0 || keptIndexes.at(row - 1) >= 0)) {
+            ++removeRanges;
+        }
+    }
+
+    if (removeRanges > MAX_INSERT_RANGES_PER_BATCH) {
+        DirItemInfoList kept;
+        kept.reserve(rows);
+        for (int row = 0; row < rows; ++row) {
+            const DirItemInfo &item = mDirectoryContents.at(row);
+            if (keptIndexes.at(row) >= 0) {
+                kept.append(item);
+            } else {
+                mChildCounts.remove(item.absoluteFilePath());
+                mAudioMetaDataRequested.remove(item.absoluteFilePath());
+                mItemStatRequested.remove(item.absoluteFilePath());
+            }
+        }
+        beginResetModel();
+        mDirectoryContents.swap(kept);
+        endResetModel();
+        keptIndexes.clear();
+        for (int counter = 0; counter < items.count(); ++counter) {
+            if (!isNew.at(counter)) {
+                keptIndexes.append(counter);
+            }
+        }
+    } else {
+        // from the end, so rows of the ranges not removed yet do not change
+        int row = rows;
+        while (row-- > 0) {
+            if (keptIndexes.at(row) < 0) {
+                int first = row;
+                while (first > 0 && keptIndexes.at(first - 1) < 0) {
+                    --first;
+                }
+                removeRowRange(first, row);
+                keptIndexes.remove(first, row - first + 1);
+                row = first;
+            }
+        }
+    }
+
+    // rows left are in the new order, the ones that changed are replaced in place
+    int changedFirst = -1;
+    for (int row = 0; row <= mDirectoryContents.count(); ++row) {
+        bool changed = false;
+        if (row < mDirectoryContents.count()) {
+            const DirItemInfo &current = mDirectoryContents.at(row);
+            const DirItemInfo &item    = items.at(keptIndexes.at(row));
+            // a row already stat'ed knows more than an item of a lazy listing
+            changed = !item.needsStat()
+                      && (current.needsStat()
+                          || current.size()              != item.size()
+                          || current.lastModifiedMSecs() != item.lastModifiedMSecs()
+                          || current.permissions()       != item.permissions());
+            if (changed) {
+                DirItemInfo copy(item);
+                mChildCounts.remove(copy.absoluteFilePath());
+                mAudioMetaDataRequested.remove(copy.absoluteFilePath());
+                mItemStatRequested.remove(copy.absoluteFilePath());
+                mDirectoryContents[row].swap(copy);
+                if (changedFirst < 0) {
+                    changedFirst = row;
+                }
+            }
+        }
+        if (!changed && changedFirst >= 0) {
+            emit dataChanged(index(changedFirst, 0), index(row - 1, 0));
+            changedFirst = -1;
+        }
+    }
+
+    DirItemInfoList added;
+    for (int counter = 0; counter < items.count(); ++counter) {
+        if (isNew.at(counter)) {
+            added.append(items.at(counter));
+        }
+    }
+    insertSortedItems(added);
+
+    Q_EMIT countChanged();
+}
+
+/*!
+ * \brief DirModel::removeRowRange() removes rows from \a first to \a last, both included
+ */
+void DirModel::removeRowRange(int first, int last)
+{
+    beginRemoveRows(QModelIndex(), first, last);
+    for (int row = first; row <= last; ++row) {
+        const DirItemInfo &item = mDirectoryContents.at(row);
+        mChildCounts.remove(item.absoluteFilePath());
+        mAudioMetaDataRequested.remove(item.absoluteFilePath());
+        mItemStatRequested.remove(item.absoluteFilePath());
+    }
+    mDirectoryContents.remove(first, last - first + 1);
+    endRemoveRows();
+}
+
+/*!
+ * \brief DirModel::removeRowRanges() removes \a rows, sorted in ascending order, by contiguous ranges
+ */
+void DirModel::removeRowRanges(const QVector<int> &rows)
+{
+    // from the end, so rows of the ranges not removed yet do not change
+    int counter = rows.count();
+    while (counter-- > 0) {
+        int first = counter;
+        while (first > 0 && rows.at(first - 1) == rows.at(first) - 1) {
+            --first;
+        }
+        removeRowRange(rows.at(first), rows.at(counter));
+        counter = first;
+    }
+}
+
+/*!
+ * \brief DirModel::listingCacheKey() returns the \ref DirListingCache key for the current path and filters
+ *
+ *  Only local disk listings are cached, other Locations cannot check changes in the background,
+ *  recursive listings and restricted paths are not cached either.
+ *
+ * \return an empty string when the current listing must not be cached
+ */
+QString DirModel::listingCacheKey() const
+{
+    if (!mCurLocation->isLocalDisk() || mIsRecursive || mOnlyAllowedPaths) {
+        return QString();
+    }
+    // the snapshot keeps the whole listing, see listingDirFilter()
+    return DirListingCache::makeKey(mCurrentDir, listingDirFilter(), QStringList(), false);
+}
+
+/*!
+ * \brief DirModel::storeListingSnapshot() saves the current listing into the \ref DirListingCache
+ *
+ *  Only complete listings are saved, the selection is kept apart from the items.
+ */
+void DirModel::storeListingSnapshot()
+{
+    if (!mAwaitingResults && !mListingCacheKey.isEmpty()) {
+        DirListingCache::instance()->insert(mListingCacheKey, mCurrentDir, mCurrentDirModified,
+                                            listingContents());
+    }
+}
+
+/*!
+ * \brief DirModel::fillFromListingCache() fills the model from a \ref DirListingCache snapshot
+ *
+ *  The snapshot is valid when the directory modification time did not change, as it does not
+ *  catch changes inside the files (size for instance) the directory is compared in background
+ *  by the \ref ExternalFileSystemChangesWorker and the differences come as external changes.
+ *
+ * \return true if the model was filled
+ */
+bool DirModel::fillFromListingCache()
+{
+    DirItemInfoList snapshot;
+    if (mListingCacheKey.isEmpty()
+            || !DirListingCache::instance()->find(mListingCacheKey, mCurrentDir, mCurrentDirModified,
+                                                  snapshot)) {
+        return false;
+    }
+
+#if DEBUG_MESSAGES
+    qDebug() << Q_FUNC_INFO << this << "using" << snapshot.count() << "cached items for" << mCurrentDir;
+#endif
+
+    //the fetch of the previous path is no longer needed
+    mCurLocation->cancelFetch();
+
+    // items were already checked by allowAccess(), filters are applied here
+    DirItemInfoList accepted;
+    accepted.reserve(snapshot.count());
+    appendToListing(snapshot);
+    foreach (const DirItemInfo &fi, snapshot) {
+        if (acceptsItem(fi)) {
+            accepted.append(fi);
+        }
+    }
+    sortItems(accepted, mCompareFunction);
+    addSortedItems(accepted);
+    Q_EMIT countChanged();
+
+    if (mAwaitingResults) {
         mAwaitingResults = false;
         emit awaitingResultsChanged();
     }
+
+    mCurLocation->fetchExternalChanges(mCurrentDir, listingContents(), listingDirFilter());
+    requestMimeTypesFromContent();
+    // the snapshot may come from a lazy listing
+    if (mSortBy != SortByName) {
+        requestPendingItemStats();
+    }
+    return true;
 }
 
 
@@ -606,30 +1142,293 @@ void DirModel::onItemsAdded(const DirItemInfoList &newFiles)
     qDebug() << Q_FUNC_INFO << this << "Got new files: " << newFiles.count();
 #endif
 
-    if (newFiles.count() > 0) {
-        mDirectoryContents.reserve(newFiles.count()) ;
+    // items may come in several batches when the loader is streaming
+    DirItemInfoList accepted;
+    accepted.reserve(newFiles.count());
+
+    // a refresh keeps the current rows until the listing is complete
+    if (mDiffRefresh) {
+        foreach (const DirItemInfo &fi, newFiles) {
+            if (allowAccess(fi)) {
+                mRefreshedContents.append(fi);
+            }
+        }
+        return;
     }
 
+    DirItemInfoList allowed;
+    allowed.reserve(newFiles.count());
     foreach (const DirItemInfo &fi, newFiles) {
         if (!allowAccess(fi)) continue;
 
-        bool doAdd = false;
-        foreach (const QString &nameFilter, mNameFilters) {
-            // TODO: using QRegExp for wildcard matching is slow
-            QRegExp re(nameFilter, Qt::CaseInsensitive, QRegExp::Wildcard);
-            if (re.exactMatch(fi.fileName()) || (fi.isDir() && !mFilterDirectories)) {
-                doAdd = true;
-                break;
-            }
+        allowed.append(fi);
+        if (acceptsItem(fi)) {
+            accepted.append(fi);
         }
+    }
+    appendToListing(allowed);
 
-        if (!doAdd)
-            continue;
+    // batches come sorted from the IO thread, unless the sort order changed meanwhile
+    sortItems(accepted, mCompareFunction);
+    addSortedItems(accepted);
+
+    Q_EMIT countChanged();
+}
+
+/*!
+ * \brief DirModel::addSortedItems() adds \a items, already sorted by \a mCompareFunction, to the listing
+ *
+ *  When \ref fetchPageSize() is 0 all of them become rows. Otherwise only the items that sort before
+ *  the last row become rows now, the others wait in \a mPendingContents for \ref fetchMore();
+ *  the first page is always filled.
+ */
+void DirModel::addSortedItems(const DirItemInfoList &items)
+{
+    if (mFetchPageSize <= 0) {
+        insertSortedItems(items);
+        return;
+    }
+
+    int split = 0;
+    if (!mDirectoryContents.isEmpty()) {
+        split = std::lower_bound(items.constBegin(), items.constEnd(), mDirectoryContents.last(),
+                                 mCompareFunction) - items.constBegin();
+    }
+    if (split > 0) {
+        insertSortedItems(split == items.count() ? items : items.mid(0, split));
+    }
+    if (split < items.count()) {
+        if (hasPendingItems() && mCompareFunction(items.at(split), mPendingContents.last())) {
+            mPendingSorted = false;
+        }
+        const int first = mPendingContents.count();
+        mPendingContents.reserve(first + items.count() - split);
+        for (int counter = split; counter < items.count(); ++counter) {
+            mPendingContents.append(items.at(counter));
+        }
+        mPendingIndex.rowsInserted(first, items.count() - split);
+    }
+    if (mDirectoryContents.count() < mFetchPageSize) {
+        exposePendingItems(mFetchPageSize - mDirectoryContents.count());
+    }
+}
+
+/*!
+ * \brief DirModel::exposePendingItems() appends up to \a count items of \a mPendingContents as rows
+ */
+void DirModel::exposePendingItems(int count)
+{
+    if (!hasPendingItems()) {
+        return;
+    }
+    sortPendingItems();
+    count = qMin(count, mPendingContents.count() - mPendingFirst);
+    if (count <= 0) {
+        return;
+    }
+
+    const int row = mDirectoryContents.count();
+    beginInsertRows(QModelIndex(), row, row + count - 1);
+    mDirectoryContents.reserve(row + count);
+    for (int counter = 0; counter < count; ++counter) {
+        mDirectoryContents.append(mPendingContents.at(mPendingFirst + counter));
+    }
+    endInsertRows();
+
+    mPendingFirst += count;
+    if (mPendingFirst == mPendingContents.count()) {
+        mPendingContents.clear();
+        mPendingFirst = 0;
+        mPendingIndex.invalidate();
+    } else if (mPendingFirst > mPendingContents.count() / 2) {
+        // exposed items are dropped from time to time instead of on every page
+        DirItemInfoList rest = mPendingContents.mid(mPendingFirst);
+        mPendingContents.swap(rest);
+        mPendingFirst = 0;
+        mPendingIndex.invalidate();
+    }
+}
+
+/*!
+ * \brief DirModel::sortPendingItems() sorts \a mPendingContents when items were added out of order
+ */
+void DirModel::sortPendingItems()
+{
+    if (!mPendingSorted) {
+        DirItemInfoList rest = mPendingContents.mid(mPendingFirst);
+        sortItems(rest, mCompareFunction);
+        mPendingContents.swap(rest);
+        mPendingFirst  = 0;
+        mPendingSorted = true;
+        mPendingIndex.invalidate();
+    }
+}
+
+/*!
+ * \brief DirModel::addPendingItem() keeps \a fi for \ref fetchMore(), it sorts after the last row
+ */
+void DirModel::addPendingItem(const DirItemInfo &fi)
+{
+    if (hasPendingItems() && mCompareFunction(fi, mPendingContents.last())) {
+        mPendingSorted = false;
+    }
+    mPendingContents.append(fi);
+    mPendingIndex.rowsInserted(mPendingContents.count() - 1, 1);
+}
+
+/*!
+ * \brief DirModel::removePendingItem() removes the item at \a index of \a mPendingContents
+ */
+void DirModel::removePendingItem(int index)
+{
+    mPendingIndex.rowsAboutToBeRemoved(index, 1);
+    mPendingContents.remove(index);
+}
 
-        addItem(fi);
+/*!
+ * \brief DirModel::pendingIndexOf() returns the index of an item not exposed yet, -1 if it is not there
+ *
+ *  It uses a \ref DirItemRowIndex as \ref rowOfItem() does, items before \a mPendingFirst are rows already.
+ */
+int DirModel::pendingIndexOf(const QString &absoluteFilePath)
+{
+    if (!hasPendingItems()) {
+        return -1;
     }
+    const int index = mPendingIndex.rowOf(absoluteFilePath);
+    return index >= mPendingFirst ? index : -1;
+}
 
+bool DirModel::hasPendingItems() const
+{
+    return mPendingFirst < mPendingContents.count();
+}
+
+/*!
+ * \brief DirModel::allContents() returns all items of the listing, rows and items not exposed yet
+ */
+DirItemInfoList DirModel::allContents() const
+{
+    if (!hasPendingItems()) {
+        return mDirectoryContents;
+    }
+    DirItemInfoList ret;
+    ret.reserve(mDirectoryContents.count() + mPendingContents.count() - mPendingFirst);
+    ret += mDirectoryContents;
+    for (int counter = mPendingFirst; counter < mPendingContents.count(); ++counter) {
+        ret.append(mPendingContents.at(counter));
+    }
+    return ret;
+}
+
+bool DirModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && hasPendingItems();
+}
+
+/*!
+ * \brief DirModel::fetchMore() exposes the next \ref fetchPageSize() rows, views call it when they reach the end
+ */
+void DirModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid() || !hasPendingItems()) {
+        return;
+    }
+    const int firstRow = mDirectoryContents.count();
+    exposePendingItems(mFetchPageSize > 0 ? mFetchPageSize : mPendingContents.count());
     Q_EMIT countChanged();
+
+    // the background pass of a complete listing only saw the rows exposed before
+    if (!mAwaitingResults) {
+        requestMimeTypesFromContent(firstRow);
+    }
+}
+
+/*!
+ * \brief DirModel::insertSortedItems() merges \a items, already sorted by \a mCompareFunction, into the model
+ *
+ *  Items that go to the same place are inserted together, so each place costs a single
+ *  rowsInserted(). When there are too many places the items are appended by one rowsInserted()
+ *  and the lists are merged in a single pass under a layout change, persistent indexes are remapped.
+ *  The model is never reset, views keep their current item and position while a folder is loading.
+ */
+void DirModel::insertSortedItems(const DirItemInfoList &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+    if (mDirectoryContents.isEmpty()) {
+        beginInsertRows(QModelIndex(), 0, items.count() - 1);
+        mDirectoryContents = items;
+        endInsertRows();
+        return;
+    }
+
+    // ranges: (row in mDirectoryContents, first index in items), both lists are sorted
+    QVector<QPair<int, int> > ranges;
+    int place = 0;
+    for (int counter = 0; counter < items.count(); ++counter) {
+        place = lowerBound(mDirectoryContents, place, items.at(counter), mCompareFunction);
+        if (ranges.isEmpty() || ranges.last().first != place) {
+            ranges.append(qMakePair(place, counter));
+        }
+    }
+
+    if (ranges.count() > MAX_INSERT_RANGES_PER_BATCH) {
+        const int oldCount = mDirectoryContents.count();
+        beginInsertRows(QModelIndex(), oldCount, oldCount + items.count() - 1);
+        mDirectoryContents += items;
+        endInsertRows();
+
+        emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+
+        // current rows: [0, oldCount) the old items, [oldCount, count) the appended ones
+        DirItemInfoList merged;
+        merged.reserve(mDirectoryContents.count());
+        QVector<int> newRowOf(mDirectoryContents.count());
+        int row = 0;
+        for (int counter = 0; counter < ranges.count(); ++counter) {
+            const int end = counter + 1 < ranges.count() ? ranges.at(counter + 1).second : items.count();
+            while (row < ranges.at(counter).first) {
+                newRowOf[row] = merged.count();
+                merged.append(mDirectoryContents.at(row++));
+            }
+            for (int item = ranges.at(counter).second; item < end; ++item) {
+                newRowOf[oldCount + item] = merged.count();
+                merged.append(items.at(item));
+            }
+        }
+        while (row < oldCount) {
+            newRowOf[row] = merged.count();
+            merged.append(mDirectoryContents.at(row++));
+        }
+        mDirectoryContents.swap(merged);
+
+        const QModelIndexList from = persistentIndexList();
+        QModelIndexList to;
+        to.reserve(from.count());
+        foreach (const QModelIndex &oldIndex, from) {
+            to.append(index(newRowOf.at(oldIndex.row()), oldIndex.column()));
+        }
+        changePersistentIndexList(from, to);
+
+        emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+        return;
+    }
+
+    // from the end, so rows of the ranges not inserted yet do not change
+    for (int counter = ranges.count() - 1; counter >= 0; --counter) {
+        const int row   = ranges.at(counter).first;
+        const int first = ranges.at(counter).second;
+        const int end   = counter + 1 < ranges.count() ? ranges.at(counter + 1).second : items.count();
+        beginInsertRows(QModelIndex(), row, row + end - first - 1);
+        mDirectoryContents.insert(row, end - first, DirItemInfo());
+        for (int item = first; item < end; ++item) {
+            DirItemInfo copy(items.at(item));
+            mDirectoryContents[row + item - first].swap(copy);
+        }
+        endInsertRows();
+    }
 }
 
 void DirModel::rm(const QStringList &paths)
@@ -690,7 +1489,7 @@ bool DirModel::rename(int row, const QString &newName)
         emit(QObject::tr("Rename error"), f.errorString());
 
     } else {
-        bool isSelected =  mDirectoryContents.at(row).isSelected();
+        bool isSelected =  mSelection->isIndexSelected(row);
         onItemRemoved(mDirectoryContents.at(row));
         int newRow = addItem(DirItemInfo(QFileInfo(newFullFilename)));
         //keep previous selected state, selection takes care of everything
@@ -754,7 +1553,7 @@ bool DirModel::showDirectories() const
 void DirModel::setShowDirectories(bool showDirectories)
 {
     mShowDirectories = showDirectories;
-    refresh();
+    applyFilters(true);
     emit showDirectoriesChanged();
 }
 
@@ -782,6 +1581,35 @@ void DirModel::setReadsMediaMetadata(bool readsMediaMetadata)
     emit readsMediaMetadataChanged();
 }
 
+int DirModel::fetchPageSize() const
+{
+    return mFetchPageSize;
+}
+
+void DirModel::setFetchPageSize(int rows)
+{
+    rows = qMax(0, rows);
+    if (rows != mFetchPageSize) {
+        mFetchPageSize = rows;
+        reload();
+        emit fetchPageSizeChanged();
+    }
+}
+
+bool DirModel::lazyMetadata() const
+{
+    return mLazyMetadata;
+}
+
+void DirModel::setLazyMetadata(bool lazy)
+{
+    if (lazy != mLazyMetadata) {
+        mLazyMetadata = lazy;
+        reload();
+        emit lazyMetadataChanged();
+    }
+}
+
 bool DirModel::filterDirectories() const
 {
     return mFilterDirectories;
@@ -790,7 +1618,7 @@ bool DirModel::filterDirectories() const
 void DirModel::setFilterDirectories(bool filterDirectories)
 {
     mFilterDirectories = filterDirectories;
-    refresh();
+    applyFilters(false);
     emit filterDirectoriesChanged();
 }
 
@@ -802,7 +1630,8 @@ QStringList DirModel::nameFilters() const
 void DirModel::setNameFilters(const QStringList &nameFilters)
 {
     mNameFilters = nameFilters;
-    refresh();
+    mNameFilterMatcher.setPatterns(mNameFilters);
+    applyFilters(false);
     emit nameFiltersChanged();
 }
 
@@ -1004,6 +1833,12 @@ bool DirModel::cdIntoPath(const QString &filename)
 
 bool DirModel::cdIntoItem(const DirItemInfo &fi)
 {
+    // a lazy listing item does not know its permissions yet, the stat() cannot wait for the IO thread
+    if (fi.needsStat()) {
+        DirItemInfo resolved(fi);
+        return resolved.resolvePendingStat() && cdIntoItem(resolved);
+    }
+
     bool ret = false;
 
     const DirItemInfo *item = &fi;
@@ -1051,6 +1886,14 @@ bool DirModel::cdIntoItem(const DirItemInfo &fi)
 
 void DirModel::onItemRemoved(const DirItemInfo &fi)
 {
+    removeFromListing(fi.absoluteFilePath());
+    if (mDiffRefresh) {
+        for (int counter = mAddedWhileRefreshing.count() - 1; counter >= 0; --counter) {
+            if (mAddedWhileRefreshing.at(counter).absoluteFilePath() == fi.absoluteFilePath()) {
+                mAddedWhileRefreshing.remove(counter);
+            }
+        }
+    }
     int row = rowOfItem(fi);
 
 #if DEBUG_MESSAGES || DEBUG_EXT_FS_WATCHER
@@ -1061,14 +1904,14 @@ void DirModel::onItemRemoved(const DirItemInfo &fi)
 #endif
 
     if (row >= 0) {
+        mChildCounts.remove(fi.absoluteFilePath());
+        mAudioMetaDataRequested.remove(fi.absoluteFilePath());
+        mItemStatRequested.remove(fi.absoluteFilePath());
         beginRemoveRows(QModelIndex(), row, row);
-
-        if (mDirectoryContents.at(row).isSelected()) {
-            mSelection->itemGoingToBeRemoved(mDirectoryContents.at(row));
-        }
-
         mDirectoryContents.remove(row, 1);
         endRemoveRows();
+    } else if ((row = pendingIndexOf(fi.absoluteFilePath())) >= 0) {
+        removePendingItem(row);
     }
 }
 
@@ -1089,9 +1932,27 @@ void DirModel::onItemAdded(const DirItemInfo &fi)
  * \return  the index where it was inserted, it can be used in the view
  * \sa insertedRow()
  */
-int DirModel::addItem(const DirItemInfo &fi)
+int DirModel::addItem(const DirItemInfo &item)
 {
-    if (!allowAccess(fi)) {
+    if (!allowAccess(item)) {
+        return -1;
+    }
+    // items created in the GUI thread get their mime type before rows share them
+    DirItemInfo fi(item);
+    fi.resolveMimeTypeFromName();
+
+    insertIntoListing(fi);
+    if (mDiffRefresh) {
+        mAddedWhileRefreshing.append(fi);
+    }
+    if (!acceptsItem(fi)) {
+        return -1;
+    }
+
+    // it does not belong to the rows exposed so far
+    if (hasPendingItems()
+            && (mDirectoryContents.isEmpty() || !mCompareFunction(fi, mDirectoryContents.last()))) {
+        addPendingItem(fi);
         return -1;
     }
 
@@ -1122,20 +1983,28 @@ int DirModel::addItem(const DirItemInfo &fi)
  *
  * \param fi DirItemInfo of the item
  */
-void DirModel::onItemChanged(const DirItemInfo &fi)
+void DirModel::onItemChanged(const DirItemInfo &item)
 {
+    DirItemInfo fi(item);
+    fi.resolveMimeTypeFromName();
     int row = rowOfItem(fi);
+    if (row >= 0 || listingIndexOf(fi.absoluteFilePath()) >= 0) {
+        insertIntoListing(fi);
+    }
 
     if (row >= 0) {
-        if (mDirectoryContents.at(row).isSelected()) {
-            mSelection->itemGoingToBeReplaced(mDirectoryContents.at(row), fi);
-            DirItemInfo *myFi = const_cast<DirItemInfo *> (&fi);
-            myFi->setSelection(true);
-        }
-
+        // its modification time may have changed, the count is looked up again
+        mChildCounts.remove(fi.absoluteFilePath());
+        mAudioMetaDataRequested.remove(fi.absoluteFilePath());
+        mItemStatRequested.remove(fi.absoluteFilePath());
         mDirectoryContents[row] = fi;
         notifyItemChanged(row);
 
+    } else if ((row = pendingIndexOf(fi.absoluteFilePath())) >= 0) {
+        // the sort position may change, it is placed again when exposed
+        mPendingContents.replace(row, fi);
+        mPendingSorted = false;
+
     } else {
         // it simplifies some logic outside, when removing and adding on the same operation
         onItemAdded(fi);
@@ -1187,7 +2056,7 @@ void DirModel::setShowHiddenFiles(bool show)
 {
     if (show != mShowHiddenFiles) {
         mShowHiddenFiles = show;
-        refresh();
+        applyFilters(true);
         emit showHiddenFilesChanged();
     }
 }
@@ -1230,17 +2099,66 @@ void DirModel::setSortBy(SortBy field)
     }
 }
 
-DirModel::SortOrder DirModel::getSortOrder() const
+DirModel::SortOrder DirModel::getSortOrder() const
+{
+    return mSortOrder;
+}
+
+void DirModel::setSortOrder(SortOrder order)
+{
+    if ( order != mSortOrder ) {
+        mSortOrder = order;
+        setCompareAndReorder();
+        emit sortOrderChanged();
+    }
+}
+
+bool DirModel::getNaturalSort() const
+{
+    return DirItemInfo::numericSortKeys();
+}
+
+void DirModel::setNaturalSort(bool natural)
+{
+    if (natural != DirItemInfo::numericSortKeys()) {
+        DirItemInfo::setNumericSortKeys(natural);
+        foreach (DirModel *model, allModels) {
+            model->onNaturalSortChanged();
+        }
+    }
+}
+
+/*!
+ * \brief DirModel::onNaturalSortChanged() reorders the items of this model in the new collation mode
+ *
+ *  The mode is shared by all models, see \ref DirItemInfo::setNumericSortKeys()
+ */
+void DirModel::onNaturalSortChanged()
+{
+    // only the name sort uses the collator
+    if (mSortBy == SortByName) {
+        // rows exposed so far or batches still coming were sorted in the previous mode
+        if (hasPendingItems() || mAwaitingResults) {
+            refresh();
+        } else {
+            reorderItems(false);
+        }
+    }
+    emit naturalSortChanged();
+}
+
+DirModel::MimeTypePolicy DirModel::getMimeTypePolicy() const
 {
-    return mSortOrder;
+    return static_cast<MimeTypePolicy> (DirItemInfo::mimeTypePolicy());
 }
 
-void DirModel::setSortOrder(SortOrder order)
+void DirModel::setMimeTypePolicy(MimeTypePolicy policy)
 {
-    if ( order != mSortOrder ) {
-        mSortOrder = order;
-        setCompareAndReorder();
-        emit sortOrderChanged();
+    if (policy != getMimeTypePolicy()) {
+        DirItemInfo::setMimeTypePolicy(static_cast<DirItemInfo::MimeTypePolicy> (policy));
+        // rows compared by a refresh would keep the mime types found with the previous policy
+        reload();
+        emit mimeTypePolicyChanged();
     }
 }
 
@@ -1257,24 +2175,91 @@ void DirModel::toggleSortBy()
 }
 
 /*!
- * \brief DirModel::setCompareAndReorder() called when  SortOrder or SortBy change
+ * \brief DirModel::setCompareAndReorder() sets the compare function from the sort settings and reorders the items
  *
- *  It does not reload items from disk, just reorganize items from \a mDirectoryContents array
+ *  When only the sort order changes each group (directories and files) is reversed,
+ *  otherwise a stable sort is done, see \ref reorderItems()
+ *
+ *  It is also done while a fetch is running, batches not sorted yet are sorted in \ref onItemsAdded()
  */
 void DirModel::setCompareAndReorder()
 {
+    const CompareFunction previous = mCompareFunction;
     mCompareFunction = availableCompareFunctions[mSortBy][mSortOrder];
 
-    if (mDirectoryContents.count() > 0 && !mAwaitingResults ) {
-        DirItemInfoList tmpDirectoryContents = mDirectoryContents;
-        beginResetModel();
-        mDirectoryContents.clear();
-        endResetModel();
+    if (previous != mCompareFunction) {
+        // rows exposed so far would not be the first ones in the new order
+        if (hasPendingItems()) {
+            refresh();
+            return;
+        }
+        if (mSortBy != SortByName) {
+            // a lazy listing gets sizes and dates first
+            if (mAwaitingResults && mListingIsLazy) {
+                refresh();
+                return;
+            }
+            if (requestPendingItemStats()) {
+                return; // items are sorted when all of them arrive
+            }
+        }
+        reorderItems(previous == availableCompareFunctions[mSortBy][mSortOrder == SortAscending ?
+                                                                    SortDescending : SortAscending]);
+    }
+}
+
+/*!
+ * \brief DirModel::reorderItems() sorts the items using \a mCompareFunction
+ *
+ *  Items are moved using layoutChanged() and persistent indexes are remapped, so the view keeps its items.
+ *
+ * \param reverseGroups true when the current order is the opposite of \a mCompareFunction,
+ *                      directories and files are just reversed
+ */
+void DirModel::reorderItems(bool reverseGroups)
+{
+    const int count = mDirectoryContents.count();
+    if (count < 2) {
+        return;
+    }
 
-        for (int counter = 0; counter < tmpDirectoryContents.count(); counter++) {
-            addItem(tmpDirectoryContents.at(counter));
+    // order[newRow] = oldRow
+    QVector<int> order(count);
+    for (int counter = 0; counter < count; ++counter) {
+        order[counter] = counter;
+    }
+    if (reverseGroups) {
+        // directories are always first
+        int dirs = 0;
+        while (dirs < count && mDirectoryContents.at(dirs).isDir()) {
+            ++dirs;
         }
+        std::reverse(order.begin(), order.begin() + dirs);
+        std::reverse(order.begin() + dirs, order.end());
+    } else {
+        sortIndexes(mDirectoryContents, order, mCompareFunction);
+    }
+
+    emit layoutAboutToBeChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
+
+    DirItemInfoList sorted;
+    sorted.reserve(count);
+    QVector<int> newRowOf(count);
+    for (int counter = 0; counter < count; ++counter) {
+        sorted.append(mDirectoryContents.at(order.at(counter)));
+        newRowOf[order.at(counter)] = counter;
     }
+    mDirectoryContents.swap(sorted);
+
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.count());
+    foreach (const QModelIndex &oldIndex, from) {
+        to.append(index(newRowOf.at(oldIndex.row()), oldIndex.column()));
+    }
+    changePersistentIndexList(from, to);
+
+    emit layoutChanged(QList<QPersistentModelIndex>(), QAbstractItemModel::VerticalSortHint);
 }
 
 int DirModel::getClipboardUrlsCounter() const
@@ -1282,32 +2267,14 @@ int DirModel::getClipboardUrlsCounter() const
     return mClipboard->storedUrlsCounter();
 }
 
+/*!
+ * \brief DirModel::rowOfItem() returns the row of the item with the same absolute path as \a fi or -1
+ *
+ *  It uses \ref DirItemRowIndex, so it does not depend on the sort order.
+ */
 int DirModel::rowOfItem(const DirItemInfo &fi)
 {
-    int row = -1;
-
-    //to use qBinaryFind() the array needs to be ordered ascending
-    if (mCompareFunction == fileCompareAscending) {
-        DirItemInfoList::Iterator it = qBinaryFind(mDirectoryContents.begin(), mDirectoryContents.end(),
-                                                   fi, fileCompareExists);
-
-        if (it != mDirectoryContents.end()) {
-            row = it - mDirectoryContents.begin();
-        }
-
-    } else { //walk through whole array
-        //TODO improve this search
-        int counter = mDirectoryContents.count();
-
-        while (counter--) {
-            if ( 0 == QString::localeAwareCompare(fi.absoluteFilePath(), mDirectoryContents.at(counter).absoluteFilePath()) ) {
-                row = counter;
-                break;
-            }
-        }
-    }
-
-    return row;
+    return mRowIndex.rowOf(fi.absoluteFilePath());
 }
 
 
@@ -1331,22 +2298,53 @@ QDir::Filters DirModel::currentDirFilter() const
     return filter;
 }
 
+/*!
+ * \brief DirModel::listingDirFilter() the filter used to read the current path
+ *
+ *  Hidden files and directories are always read, \ref acceptsItem() filters them in memory.
+ *  Recursive listings use \ref currentDirFilter() as hidden directories are not entered.
+ */
+QDir::Filters DirModel::listingDirFilter() const
+{
+    if (mIsRecursive) {
+        return currentDirFilter();
+    }
+    return QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden;
+}
+
 /*!
  * \brief DirModel::dirItems() Gets a Dir number of Items, used only for Local Disk
  *
  *    For remote Locations this function is not used
  *
+ *    The directory is never read here: the count comes from \ref DirChildCountCache or,
+ *    when it is not there, a placeholder is returned and the directory is queued
+ *    to \ref requestChildCounts(), the row is updated when the count arrives.
+ *
  * \param fi
  * \return A string saying how many items a directory has
  */
 QString DirModel::dirItems(const DirItemInfo &fi) const
 {
-    int counter = 0;
-    QDir d(fi.absoluteFilePath(), QString(), QDir::NoSort, currentDirFilter());
-    counter = d.count();
+    const QString path = fi.absoluteFilePath();
+    int counter = mChildCounts.value(path, -1);
+
+    if (counter < 0 && !mChildCounts.contains(path)) {
+        if (DirChildCountCache::instance()->find(path, currentDirFilter(), fi.lastModified(), counter)) {
+            mChildCounts.insert(path, counter);
+        } else {
+            mChildCounts.insert(path, -1);
+            if (mChildCountsQueue.isEmpty()) {
+                // all rows a view asks for in this event loop pass go in the same request
+                QMetaObject::invokeMethod(const_cast<DirModel *> (this), "requestChildCounts",
+                                          Qt::QueuedConnection);
+            }
+            mChildCountsQueue.append(path);
+        }
+    }
 
     if (counter < 0) {
-        counter = 0;
+        return QObject::tr("counting items");
     }
 
     QString ret (QString::number(counter) + QLatin1Char(' '));
@@ -1354,6 +2352,182 @@ QString DirModel::dirItems(const DirItemInfo &fi) const
     return ret;
 }
 
+/*!
+ * \brief DirModel::requestChildCounts() counts the directories queued by \ref dirItems() in the IO pool
+ */
+void DirModel::requestChildCounts()
+{
+    if (mChildCountsQueue.isEmpty()) {
+        return;
+    }
+
+    const QDir::Filters filter = currentDirFilter();
+    DirChildCounter *counter   = new DirChildCounter(mChildCountsQueue, filter);
+    mChildCountsQueue.clear();
+
+    const IORequestCancelToken token = mListingToken;
+    counter->setCancelToken(token);
+    connect(counter, &DirChildCounter::countsReady, this, [this, token, filter](const DirChildCountList & counts) {
+        foreach (const DirChildCount &childCount, counts) {
+            DirChildCountCache::instance()->insert(filter, childCount);
+        }
+        // the listing was cleared, the counts are only useful for the cache
+        if (token.isCancelled()) {
+            return;
+        }
+        foreach (const DirChildCount &childCount, counts) {
+            if (!mChildCounts.contains(childCount.path)) {
+                continue;
+            }
+            mChildCounts.insert(childCount.path, childCount.count);
+            const int row = mRowIndex.rowOf(childCount.path);
+            if (row >= 0) {
+                const QModelIndex changed = index(row, 0);
+                emit dataChanged(changed, changed, QVector<int>() << FileSizeRole);
+            }
+        }
+    });
+
+    IOScheduler::instance()->pool(IOScheduler::LocalDiskPool)->addRequest(counter);
+}
+
+/*!
+ * \brief DirModel::requestMimeTypesFromContent() starts the background pass that reads the content
+ *  of the files \ref DirItemInfo::mimeTypePolicy() says the name is not enough for
+ *
+ *  Rows are updated as batches of items arrive, an item that changed in the meantime is not touched.
+ */
+void DirModel::requestMimeTypesFromContent(int firstRow)
+{
+    DirItemInfoList pending;
+    for (int counter = firstRow; counter < mDirectoryContents.count(); ++counter) {
+        if (mDirectoryContents.at(counter).needsMimeTypeFromContent()) {
+            pending.append(mDirectoryContents.at(counter));
+        }
+    }
+    if (pending.isEmpty()) {
+        return;
+    }
+
+#if DEBUG_MESSAGES
+    qDebug() << Q_FUNC_INFO << this << "reading content of" << pending.count() << "files";
+#endif
+
+    MimeTypeResolver *resolver = new MimeTypeResolver(pending);
+    const IORequestCancelToken token = mListingToken;
+    resolver->setCancelToken(token);
+    connect(resolver, &MimeTypeResolver::resolved, this, [this, token](const DirItemInfoList & items) {
+        if (token.isCancelled()) {
+            return;
+        }
+        foreach (const DirItemInfo &item, items) {
+            const int row = mRowIndex.rowOf(item.absoluteFilePath());
+            // an item of a lazy listing may have been stat'ed after being read
+            if (row >= 0
+                    && mDirectoryContents.at(row).needsMimeTypeFromContent()
+                    && (item.needsStat()
+                        || mDirectoryContents.at(row).lastModifiedMSecs() == item.lastModifiedMSecs())) {
+                mDirectoryContents[row].setMimeTypeFromContent(item.mimeType());
+                const QModelIndex changed = index(row, 0);
+                emit dataChanged(changed, changed,
+                                 QVector<int>() << IconNameRole << MimeTypeRole << MimeTypeDescriptionRole);
+            }
+        }
+    });
+
+    IOScheduler::instance()->pool(IOScheduler::LocalDiskPool)->addRequest(resolver);
+}
+
+/*!
+ * \brief DirModel::queueItemStat() queues a row of a lazy listing to \ref requestItemStats()
+ */
+void DirModel::queueItemStat(const DirItemInfo &fi) const
+{
+    const QString path = fi.absoluteFilePath();
+    if (!mItemStatRequested.contains(path)) {
+        mItemStatRequested.insert(path);
+        if (mItemStatQueue.isEmpty()) {
+            // all rows a view asks for in this event loop pass go in the same request
+            QMetaObject::invokeMethod(const_cast<DirModel *> (this), "requestItemStats",
+                                      Qt::QueuedConnection);
+        }
+        mItemStatQueue.append(fi);
+    }
+}
+
+/*!
+ * \brief DirModel::requestItemStats() stats the rows queued by \ref queueItemStat() in the IO pool
+ */
+void DirModel::requestItemStats()
+{
+    if (mItemStatQueue.isEmpty()) {
+        return;
+    }
+    addItemStatResolver(mItemStatQueue, false);
+    mItemStatQueue.clear();
+}
+
+/*!
+ * \brief DirModel::requestPendingItemStats() stats all items of a lazy listing, then sorts them
+ * \return false when there is no item to stat
+ */
+bool DirModel::requestPendingItemStats()
+{
+    DirItemInfoList pending;
+    for (int counter = 0; counter < mDirectoryContents.count(); ++counter) {
+        const DirItemInfo &item = mDirectoryContents.at(counter);
+        if (item.needsStat()) {
+            mItemStatRequested.insert(item.absoluteFilePath());
+            pending.append(item);
+        }
+    }
+    if (pending.isEmpty()) {
+        return false;
+    }
+
+#if DEBUG_MESSAGES
+    qDebug() << Q_FUNC_INFO << this << "reading size and dates of" << pending.count() << "items";
+#endif
+
+    addItemStatResolver(pending, true);
+    return true;
+}
+
+/*!
+ * \brief DirModel::addItemStatResolver() merges the stat of \a items into their rows as batches arrive
+ *
+ *  When \a reorderWhenDone is true the items are sorted again after the last batch.
+ */
+void DirModel::addItemStatResolver(const DirItemInfoList &items, bool reorderWhenDone)
+{
+    ItemStatResolver *resolver = new ItemStatResolver(items);
+    const IORequestCancelToken token = mListingToken;
+    resolver->setCancelToken(token);
+    connect(resolver, &ItemStatResolver::resolved, this, [this, token](const DirItemInfoList & stated) {
+        if (token.isCancelled()) {
+            return;
+        }
+        foreach (const DirItemInfo &item, stated) {
+            const int row = mRowIndex.rowOf(item.absoluteFilePath());
+            if (row >= 0 && mDirectoryContents.at(row).needsStat()) {
+                mDirectoryContents[row].setMetaDataFrom(item);
+                // size, dates, permissions and everything that depends on them
+                const QModelIndex changed = index(row, 0);
+                emit dataChanged(changed, changed);
+            }
+        }
+    });
+    if (reorderWhenDone) {
+        connect(resolver, &ItemStatResolver::finished, this, [this, token]() {
+            if (!token.isCancelled() && mSortBy != SortByName) {
+                reorderItems(false);
+            }
+        });
+    }
+
+    IOScheduler::instance()->pool(IOScheduler::LocalDiskPool)->addRequest(resolver);
+}
+
 bool DirModel::openIndex(int row)
 {
     bool ret = false;
@@ -1386,7 +2560,7 @@ bool DirModel::openPath(const QString &filename)
         } else {
             Location *location = mLocationFactory->setNewPath(myFilename);
             if (location) {
-                mCurLocation = location;
+                setCurrentLocation(location);
                 setPathFromCurrentLocation();
                 ret = true;
 
@@ -1409,6 +2583,11 @@ bool DirModel::openPath(const QString &filename)
  */
 bool DirModel::openItem(const DirItemInfo &fi)
 {
+    if (fi.needsStat()) {
+        DirItemInfo resolved(fi);
+        return resolved.resolvePendingStat() && openItem(resolved);
+    }
+
     bool ret = false;
 
     if (fi.isBrowsable()) {
@@ -1434,83 +2613,195 @@ void DirModel::onThereAreExternalChanges(const QString &pathModifiedOutside)
 #endif
 
         mCurLocation->fetchExternalChanges(pathModifiedOutside,
-                                           mDirectoryContents,
-                                           currentDirFilter());
+                                           listingContents(),
+                                           listingDirFilter());
     }
-
-#if DEBUG_EXT_FS_WATCHER
     else {
+        // the listing being read may have missed it, see replayExternalChanges()
+        mQueuedPathChanges.insert(pathModifiedOutside);
+#if DEBUG_EXT_FS_WATCHER
         qDebug() << "[extFsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
-                 << Q_FUNC_INFO << this << "Busy, nothing to do";
-    }
+                 << Q_FUNC_INFO << this << "Busy, checked when the listing is complete";
 #endif
-
+    }
 }
 
 /*!
- * \brief DirModel::onItemAddedOutsideFm() It receives a  signal saying an item was added by other application
- * \param fi
+ * \brief DirModel::onThereAreExternalEntryChanges() checks only the entries \a names of \a path
+ *
+ *  Only the items of those names are passed, so the cost does not depend on the size of the listing.
  */
-void DirModel::onItemAddedOutsideFm(const DirItemInfo &fi)
+void DirModel::onThereAreExternalEntryChanges(const QString &path, const QStringList &names)
 {
+    if ( IS_FILE_MANAGER_IDLE() ) {
+
 #if DEBUG_EXT_FS_WATCHER
-    int before  = rowCount();
+        qDebug() << "[extFsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
+                 << Q_FUNC_INFO << this << "File System modified in" << path << "entries:" << names.count();
 #endif
 
-    if (IS_FILE_MANAGER_IDLE()) {
-        int row = rowOfItem(fi);
-        if (row == -1) {
-            onItemAdded(fi);
+        const QDir dir(path);
+        DirItemInfoList items;
+        foreach (const QString &name, names) {
+            const int index = listingIndexOf(dir.absoluteFilePath(name));
+            if (index >= 0) {
+                items.append(mListing.at(index));
+            }
+        }
+        mCurLocation->fetchExternalEntryChanges(path, names, items, listingDirFilter());
+    }
+    else {
+        // the listing being read may have missed them, see replayExternalChanges()
+        QSet<QString> &queued = mQueuedEntryChanges[path];
+        foreach (const QString &name, names) {
+            queued.insert(name);
         }
     }
-
-#if DEBUG_EXT_FS_WATCHER
-    qDebug() << "[extFsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
-             << Q_FUNC_INFO << this
-             << "counterBefore:" << before
-             << "added" << fi.absoluteFilePath()
-             << "counterAfter:" << rowCount();
-#endif
-
 }
 
 /*!
- * \brief DirModel::onItemRemovedOutSideFm() It receives a  signal saying an item was removed by other application
+ * \brief DirModel::replayExternalChanges() checks the changes notified while the listing was being read
  *
- * Just calls \ref onItemRemoved() which already checks if the item exists
- *
- * \param fi
+ *  A path modified as a whole is compared again, otherwise only its entries are checked.
  */
-void DirModel::onItemRemovedOutSideFm(const DirItemInfo &fi)
+void DirModel::replayExternalChanges()
 {
-    if (IS_FILE_MANAGER_IDLE()) {
-
-#if DEBUG_EXT_FS_WATCHER
-        qDebug() << "[extFsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
-                 << Q_FUNC_INFO << this << "removed" << fi.absoluteFilePath();
-#endif
+    QSet<QString> paths;
+    paths.swap(mQueuedPathChanges);
+    QHash<QString, QSet<QString> > entries;
+    entries.swap(mQueuedEntryChanges);
 
-        onItemRemoved(fi);
+    foreach (const QString &path, paths) {
+        onThereAreExternalChanges(path);
+    }
+    QHash<QString, QSet<QString> >::ConstIterator it = entries.constBegin();
+    for ( ; it != entries.constEnd(); ++it) {
+        if (!paths.contains(it.key())) {
+            onThereAreExternalEntryChanges(it.key(), it.value().toList());
+        }
     }
 }
 
 /*!
- * \brief DirModel::onItemChangedOutSideFm()
+ * \brief DirModel::onItemsChangedOutsideFm() applies the changes other applications made to the current path
  *
- * A File or a Dir modified by other applications: size,date, permissions
+ *  All changes found by a compare come together: removed rows go in contiguous ranges, changed rows
+ *  are replaced in place and notified by range, unless their sort position moved, then they are
+ *  removed and merged again with the added items by \ref addSortedItems().
+ *
+ * \param changes
  */
-void DirModel::onItemChangedOutSideFm(const DirItemInfo &fi)
+void DirModel::onItemsChangedOutsideFm(const DirItemChangeSet &changes)
 {
-    if (IS_FILE_MANAGER_IDLE()) {
-        onItemChanged(fi);
+    if (!IS_FILE_MANAGER_IDLE()) {
+        return;
+    }
 
 #if DEBUG_EXT_FS_WATCHER
-        qDebug() << "[extFsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
-                 << Q_FUNC_INFO << this << "changed" << fi.absoluteFilePath()
-                 << "from row" << rowOfItem(fi);
+    int before  = rowCount();
 #endif
 
+    // removed
+    QVector<int> rows;
+    rows.reserve(changes.removed.count());
+    foreach (const DirItemInfo &fi, changes.removed) {
+        removeFromListing(fi.absoluteFilePath());
+        const int row = rowOfItem(fi);
+        if (row >= 0) {
+            rows.append(row);
+        } else {
+            const int pending = pendingIndexOf(fi.absoluteFilePath());
+            if (pending >= 0) {
+                removePendingItem(pending);
+            }
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    removeRowRanges(rows);
+
+    // changed
+    DirItemInfoList added;
+    rows.clear();
+    foreach (const DirItemInfo &fi, changes.changed) {
+        const int row = rowOfItem(fi);
+        if (row >= 0) {
+            insertIntoListing(fi);
+            mChildCounts.remove(fi.absoluteFilePath());
+            mAudioMetaDataRequested.remove(fi.absoluteFilePath());
+            mItemStatRequested.remove(fi.absoluteFilePath());
+            DirItemInfo copy(fi);
+            mDirectoryContents[row].swap(copy);
+            rows.append(row);
+        } else if (listingIndexOf(fi.absoluteFilePath()) >= 0) {
+            insertIntoListing(fi);
+            const int pending = pendingIndexOf(fi.absoluteFilePath());
+            if (pending >= 0) {
+                // the sort position may change, it is placed again when exposed
+                mPendingContents.replace(pending, fi);
+                mPendingSorted = false;
+            }
+        } else {
+            added.append(fi);
+        }
+    }
+    // a range of changed rows still sorted among the rows around it stays in place,
+    // otherwise its items are removed and inserted again where they sort now
+    std::sort(rows.begin(), rows.end());
+    DirItemInfoList moved;
+    QVector<int> movedRows;
+    for (int counter = 0; counter < rows.count(); ++counter) {
+        const int first = counter;
+        while (counter + 1 < rows.count() && rows.at(counter + 1) == rows.at(counter) + 1) {
+            ++counter;
+        }
+        const int firstRow = rows.at(first);
+        const int lastRow  = rows.at(counter);
+        const int endRow   = qMin(lastRow + 1, mDirectoryContents.count() - 1);
+        bool sorted = true;
+        for (int row = qMax(firstRow, 1); sorted && row <= endRow; ++row) {
+            sorted = !mCompareFunction(mDirectoryContents.at(row), mDirectoryContents.at(row - 1));
+        }
+        if (sorted) {
+            notifyItemsChanged(firstRow, lastRow);
+        } else {
+            for (int row = firstRow; row <= lastRow; ++row) {
+                moved.append(mDirectoryContents.at(row));
+                movedRows.append(row);
+            }
+        }
+    }
+    removeRowRanges(movedRows);
+
+    // added, items already known are skipped, moved items go back with them
+    DirItemInfoList accepted(moved);
+    DirItemInfoList allowed;
+    accepted.reserve(moved.count() + changes.added.count() + added.count());
+    for (int list = 0; list < 2; ++list) {
+        foreach (const DirItemInfo &fi, list == 0 ? changes.added : added) {
+            if (!allowAccess(fi) || listingIndexOf(fi.absoluteFilePath()) >= 0) {
+                continue;
+            }
+            allowed.append(fi);
+            if (acceptsItem(fi)) {
+                accepted.append(fi);
+            }
+        }
     }
+    appendToListing(allowed);
+    sortItems(accepted, mCompareFunction);
+    addSortedItems(accepted);
+
+    Q_EMIT countChanged();
+
+#if DEBUG_EXT_FS_WATCHER
+    qDebug() << "[extFsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
+             << Q_FUNC_INFO << this
+             << "counterBefore:" << before
+             << "added:"   << accepted.count()
+             << "removed:" << changes.removed.count()
+             << "changed:" << changes.changed.count()
+             << "counterAfter:" << rowCount();
+#endif
 }
 
 
@@ -1651,12 +2942,43 @@ int DirModel::getProgressCounter() const
 
 void DirModel::clear()
 {
+    mListingToken.cancel();
+    mListingToken = IORequestCancelToken();
+    mChildCounts.clear();
+    mChildCountsQueue.clear();
+    mAudioMetaDataQueue.clear();
+    mAudioMetaDataRequested.clear();
+    mItemStatQueue.clear();
+    mItemStatRequested.clear();
+    mPendingContents.clear();
+    mPendingFirst  = 0;
+    mPendingSorted = true;
+    mPendingIndex.invalidate();
+    mDiffRefresh   = false;
+    mRefreshedContents.clear();
+    mAddedWhileRefreshing.clear();
+    mListing.clear();
+    mListingSorted = true;
+    mQueuedPathChanges.clear();
+    mQueuedEntryChanges.clear();
+
+    mSelection->clear();
     beginResetModel();
     mDirectoryContents.clear();
-    mSelection->clear();
     endResetModel();
 }
 
+/*!
+ * \brief DirModel::reload() reads the current path from scratch, no current row is kept
+ *
+ *  Used when items read again would not differ from the current rows in what \ref applyContents() compares
+ */
+void DirModel::reload()
+{
+    clear();
+    refresh();
+}
+
 DirSelection *DirModel::selectionObject() const
 {
     return mSelection;
@@ -1674,7 +2996,7 @@ void DirModel::componentComplete()
     // from QML, we've got huge issue since DirModel used to start fetching results
     // when not all the QML properties were already set. The result was that our last
     // requests (with all the properties set) were skipped
-    // (check for ref. setPath() -> mAwaitingResults).
+    // (check for ref. setPath()).
     // We have therefore decided to defer any operation until everything was properly
     // set up and initialized from the QML side.
 
@@ -1767,17 +3089,27 @@ void DirModel::registerMetaTypes()
 {
     qRegisterMetaType<DirItemInfoList>("DirItemInfoList");
     qRegisterMetaType<DirItemInfo>("DirItemInfo");
+    qRegisterMetaType<DirItemChangeSet>("DirItemChangeSet");
+    qRegisterMetaType<DirChildCountList>("DirChildCountList");
+#ifndef DO_NOT_USE_TAG_LIB
+    qRegisterMetaType<AudioMetaDataList>("AudioMetaDataList");
+#endif
 }
 
 void DirModel::notifyItemChanged(int row)
 {
-    QModelIndex first = index(row, 0);
+    notifyItemsChanged(row, row);
+}
+
+void DirModel::notifyItemsChanged(int firstRow, int lastRow)
+{
+    QModelIndex first = index(firstRow, 0);
 
 #if REGRESSION_TEST_FOLDERLISTMODEL
-    QModelIndex last  = index(row, columnCount()); //Table only when testing
+    QModelIndex last  = index(lastRow, columnCount()); //Table only when testing
 
 #else
-    QModelIndex last  = first; //QML uses Listview, just one column
+    QModelIndex last  = index(lastRow, 0); //QML uses Listview, just one column
 #endif
 
     emit dataChanged(first, last);
@@ -1839,8 +3171,8 @@ void DirModel::emptyTrash()
     if ( IS_BROWSING_TRASH_ROOTDIR() ) {
         QStringList allItems;
 
-        for (int counter = 0; counter < rowCount(); ++counter) {
-            allItems.append(mDirectoryContents.at(counter).absoluteFilePath());
+        foreach (const DirItemInfo &item, allContents()) {
+            allItems.append(item.absoluteFilePath());
         }
 
         if (allItems.count() > 0) {
@@ -1939,50 +3271,92 @@ bool DirModel::downloadAsTemporaryFile(int index)
 }
 
 #ifndef DO_NOT_USE_TAG_LIB
-QVariant DirModel::getAudioMetaData(const QFileInfo &fi, int role) const
-{
-    QVariant empty;
-
-    if (!fi.isDir()) {
-        TagLib::FileRef f(fi.absoluteFilePath().toStdString().c_str(), true, TagLib::AudioProperties::Fast);
-        TagLib::MPEG::File mp3(fi.absoluteFilePath().toStdString().c_str(), true, TagLib::MPEG::Properties::Fast);
-        TagLib::Tag *tag = f.tag();
-
-        if (tag) {
-            TagLib::ID3v2::FrameList list = mp3.ID3v2Tag()->frameListMap()["APIC"];
-            switch (role) {
-            case TrackTitleRole:
-                return QString::fromUtf8(tag->title().toCString(true));
-            case TrackArtistRole:
-                return QString::fromUtf8(tag->artist().toCString(true));
-            case TrackAlbumRole:
-                return QString::fromUtf8(tag->album().toCString(true));
-            case TrackYearRole:
-                return QString::number(tag->year());
-            case TrackNumberRole:
-                return QString::number(tag->track());
-            case TrackGenreRole:
-                return QString::fromUtf8(tag->genre().toCString(true));
-            case TrackLengthRole:
-                if (!f.isNull() && f.audioProperties()) {
-                    return QString::number(f.audioProperties()->length());
-
-                } else {
-                    return QString::number(0);
-                }
-            case TrackCoverRole:
-                if (!list.isEmpty()) {
-                    TagLib::ID3v2::AttachedPictureFrame *Pic = static_cast<TagLib::ID3v2::AttachedPictureFrame *>(list.front());
-                    QImage img;
-                    img.loadFromData((const uchar *) Pic->picture().data(), Pic->picture().size());
-                    return img;
-                }
-            default:
-                break;
-            } //switch
-        }//if (tag)
+/*!
+ * \brief DirModel::getAudioMetaData() returns a Track role from the \ref AudioMetaDataCache
+ *
+ *  Files not in the cache are queued to \ref requestAudioMetaData() and an empty value is returned,
+ *  the row gets a dataChanged() when the tags arrive.
+ */
+QVariant DirModel::getAudioMetaData(const DirItemInfo &fi, int role) const
+{
+    if (fi.isDir()) {
+        return QVariant();
+    }
+
+    const QString path = fi.absoluteFilePath();
+    AudioMetaData data;
+    if (!AudioMetaDataCache::instance()->find(path, fi.size(), fi.lastModified(), data)) {
+        if (!mAudioMetaDataRequested.contains(path)) {
+            mAudioMetaDataRequested.insert(path);
+            if (mAudioMetaDataQueue.isEmpty()) {
+                QMetaObject::invokeMethod(const_cast<DirModel *> (this), "requestAudioMetaData",
+                                          Qt::QueuedConnection);
+            }
+            mAudioMetaDataQueue.append(fi);
+        }
+        return QVariant();
+    }
+
+    switch (role) {
+    case TrackTitleRole:
+        return data.title;
+    case TrackArtistRole:
+        return data.artist;
+    case TrackAlbumRole:
+        return data.album;
+    case TrackYearRole:
+        return QString::number(data.year);
+    case TrackNumberRole:
+        return QString::number(data.track);
+    case TrackGenreRole:
+        return data.genre;
+    case TrackLengthRole:
+        return QString::number(data.length);
+    case TrackCoverRole:
+        // decoded in the background by the CoverArtImageProvider, see plugin.cpp
+        if (data.hasCover) {
+            return QLatin1String("image://cover-art/") + path;
+        }
+        break;
+    default:
+        break;
     }
 
-    return empty;
+    return QVariant();
 }
 #endif
+
+/*!
+ * \brief DirModel::requestAudioMetaData() reads the tags of the files queued by \ref getAudioMetaData()
+ */
+void DirModel::requestAudioMetaData()
+{
+#ifndef DO_NOT_USE_TAG_LIB
+    if (mAudioMetaDataQueue.isEmpty()) {
+        return;
+    }
+
+    AudioMetaDataExtractor *extractor = new AudioMetaDataExtractor(mAudioMetaDataQueue);
+    mAudioMetaDataQueue.clear();
+
+    const IORequestCancelToken token = mListingToken;
+    extractor->setCancelToken(token);
+    connect(extractor, &AudioMetaDataExtractor::extracted, this, [this, token](const AudioMetaDataList & records) {
+        if (token.isCancelled()) {
+            return;
+        }
+        foreach (const AudioMetaData &data, records) {
+            const int row = mRowIndex.rowOf(data.path);
+            if (row >= 0) {
+                const QModelIndex changed = index(row, 0);
+                emit dataChanged(changed, changed,
+                                 QVector<int>() << TrackTitleRole << TrackArtistRole << TrackAlbumRole
+                                 << TrackYearRole << TrackNumberRole << TrackGenreRole
+                                 << TrackLengthRole << TrackCoverRole);
+            }
+        }
+    });
+
+    IOScheduler::instance()->pool(IOScheduler::LocalDiskPool)->addRequest(extractor);
+#endif
+}
@@ -36,12 +36,16 @@
 #include <QStringList>
 #include <QDir>
 #include <QSet>
+#include <QHash>
 #include <QQmlParserStatus>
 
 #include "iorequest.h"
 #include "filecompare.h"
 #include "diritemabstractlistmodel.h"
 #include "diriteminfo.h"
+#include "diritemrowindex.h"
+#include "dirchildcounter.h"
+#include "namefiltermatcher.h"
 
 class FileSystemAction;
 class Clipboard;
@@ -62,6 +66,8 @@ class DirModel : public DirItemAbstractListModel, public QQmlParserStatus
     Q_PROPERTY(bool filterDirectories READ filterDirectories WRITE setFilterDirectories NOTIFY filterDirectoriesChanged)
     Q_PROPERTY(bool isRecursive READ isRecursive WRITE setIsRecursive NOTIFY isRecursiveChanged)
     Q_PROPERTY(bool readsMediaMetadata READ readsMediaMetadata WRITE setReadsMediaMetadata NOTIFY readsMediaMetadataChanged)
+    Q_PROPERTY(bool lazyMetadata READ lazyMetadata WRITE setLazyMetadata NOTIFY lazyMetadataChanged)
+    Q_PROPERTY(int fetchPageSize READ fetchPageSize WRITE setFetchPageSize NOTIFY fetchPageSizeChanged)
     Q_PROPERTY(bool showDirectories READ showDirectories WRITE setShowDirectories NOTIFY showDirectoriesChanged)
     Q_PROPERTY(QStringList nameFilters READ nameFilters WRITE setNameFilters NOTIFY nameFiltersChanged)
     Q_PROPERTY(DirSelection *selectionObject READ selectionObject CONSTANT)
@@ -70,6 +76,8 @@ class DirModel : public DirItemAbstractListModel, public QQmlParserStatus
     Q_PROPERTY(bool onlyAllowedPaths READ getOnlyAllowedPaths WRITE setOnlyAllowedPaths NOTIFY onlyAllowedPathsChanged)
     Q_PROPERTY(SortBy sortBy READ getSortBy WRITE setSortBy NOTIFY sortByChanged)
     Q_PROPERTY(SortOrder sortOrder READ getSortOrder WRITE setSortOrder NOTIFY sortOrderChanged)
+    Q_PROPERTY(bool naturalSort READ getNaturalSort WRITE setNaturalSort NOTIFY naturalSortChanged)
+    Q_PROPERTY(MimeTypePolicy mimeTypePolicy READ getMimeTypePolicy WRITE setMimeTypePolicy NOTIFY mimeTypePolicyChanged)
     Q_PROPERTY(int clipboardUrlsCounter READ getClipboardUrlsCounter NOTIFY clipboardChanged)
     Q_PROPERTY(bool enableExternalFSWatcher READ getEnabledExternalFSWatcher WRITE setEnabledExternalFSWatcher NOTIFY enabledExternalFSWatcherChanged)
 
@@ -254,6 +262,9 @@ public:
 
     // TODO: this won't be safe if the model can change under the holder of the row
     Q_INVOKABLE QVariant data(int row, const QByteArray &stringRole) const;
+    /*!
+     * \brief refresh() reads the current path again, current rows stay and only the differences are applied
+     */
     Q_INVOKABLE void refresh()
     {
         // just some syntactical sugar really
@@ -265,6 +276,7 @@ public:
     //DirItemAbstractListModel
     virtual int getIndex(const QString &name);
     virtual void notifyItemChanged(int row);
+    virtual void notifyItemsChanged(int firstRow, int lastRow);
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
 
@@ -276,6 +288,9 @@ public:
         return mDirectoryContents.count();
     }
 
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
     inline QString path() const
     {
         return mCurrentDir;
@@ -288,6 +303,8 @@ public:
     bool filterDirectories() const;
     bool isRecursive() const;
     bool readsMediaMetadata() const;
+    bool lazyMetadata() const;
+    int  fetchPageSize() const;
     bool showDirectories() const;
     QStringList nameFilters() const;
 
@@ -322,6 +339,15 @@ public:
         SortDescending = Qt::DescendingOrder
     };
     SortOrder getSortOrder() const;
+    bool      getNaturalSort() const;
+
+    Q_ENUMS(MimeTypePolicy)
+    enum MimeTypePolicy {
+        MimeTypeFromExtension            = DirItemInfo::MimeTypeFromExtension,
+        MimeTypeFromExtensionThenContent = DirItemInfo::MimeTypeFromExtensionThenContent,
+        MimeTypeFromContent              = DirItemInfo::MimeTypeFromContent
+    };
+    MimeTypePolicy getMimeTypePolicy() const;
 
 
     int getClipboardUrlsCounter() const;
@@ -414,6 +440,20 @@ public slots:   // Also invokable from QML
 
     void setIsRecursive(bool isRecursive);
     void setReadsMediaMetadata(bool readsMediaMetadata);
+    /*!
+     * \brief when set to true local folders sorted by name are listed reading only names and types
+     *
+     *  Size, dates and permissions of a row are read when the row is shown,
+     *  all of them are read when sorting by size or date.
+     */
+    void setLazyMetadata(bool lazy);
+    /*!
+     * \brief sets how many rows each \ref fetchMore() exposes, 0 (the default) exposes all rows at once
+     *
+     *  When it is greater than 0 the listing is exposed page by page as the view scrolls,
+     *  \ref count and selections refer to the rows exposed so far.
+     */
+    void setFetchPageSize(int rows);
     void setFilterDirectories(bool filterDirectories);
     void setShowDirectories(bool showDirectories);
     void setShowHiddenFiles(bool show);
@@ -423,6 +463,16 @@ public slots:   // Also invokable from QML
     void setOnlyAllowedPaths(bool onlyAllowedPaths);
     void setSortBy(SortBy field);
     void setSortOrder(SortOrder order);
+    /*!
+     * \brief when set to true numbers inside names are compared by value, it applies to the whole application
+     */
+    void setNaturalSort(bool natural);
+    /*!
+     * \brief sets how mime types are found, it applies to the whole application
+     *
+     *  The file content is read by a background pass after the listing, never when a role is asked for
+     */
+    void setMimeTypePolicy(MimeTypePolicy policy);
     void setEnabledExternalFSWatcher(bool enable);
 
 
@@ -453,11 +503,14 @@ private:
     QHash<int, QByteArray> buildRoleNames() const;
     QHash<int, QByteArray> roleNames() const;
     QStringList mNameFilters;
+    NameFilterMatcher mNameFilterMatcher; //!< compiled \ref mNameFilters
     bool mFilterDirectories;
     bool mShowDirectories;
     bool mAwaitingResults;
     bool mIsRecursive;
     bool mReadsMediaMetadata;
+    bool mLazyMetadata;
+    bool mListingIsLazy;        //!< the current listing was fetched without stat(), see \ref setLazyMetadata()
     QString mCurrentDir;
     DirItemInfoList  mDirectoryContents;
 
@@ -469,6 +522,8 @@ signals:
     void filterDirectoriesChanged();
     void isRecursiveChanged();
     void readsMediaMetadataChanged();
+    void lazyMetadataChanged();
+    void fetchPageSizeChanged();
     void showDirectoriesChanged();
     void pathChanged(const QString &newPath);
     void error(const QString &errorTitle, const QString &errorMessage);
@@ -510,6 +565,8 @@ signals:
     void     onlyAllowedPathsChanged();
     void     sortByChanged();
     void     sortOrderChanged();
+    void     naturalSortChanged();
+    void     mimeTypePolicyChanged();
     void     clipboardChanged();
     void     enabledExternalFSWatcherChanged(bool);
 
@@ -526,26 +583,59 @@ private slots:
 
 private:
     int           addItem(const DirItemInfo &fi);
+    void          insertSortedItems(const DirItemInfoList &items);
+    void          addSortedItems(const DirItemInfoList &items);
+    void          exposePendingItems(int count);
+    void          sortPendingItems();
+    void          addPendingItem(const DirItemInfo &fi);
+    int           pendingIndexOf(const QString &absoluteFilePath);
+    void          removePendingItem(int index);
+    bool          hasPendingItems() const;
+    DirItemInfoList allContents() const;
+    DirItemInfoList listingContents();
+    int           listingIndexOf(const QString &absoluteFilePath);
+    void          insertIntoListing(const DirItemInfo &fi);
+    void          removeFromListing(const QString &absoluteFilePath);
+    void          appendToListing(const DirItemInfoList &items);
+    void          sortListing();
+    void          applyRefreshedContents();
+    void          applyContents(DirItemInfoList items);
+    void          applyFilters(bool childCountsChanged);
+    bool          acceptsItem(const DirItemInfo &fi) const;
+    void          removeRowRange(int first, int last);
+    void          removeRowRanges(const QVector<int> &rows);
     void          setCompareAndReorder();
+    void          reorderItems(bool reverseGroups);
+    void          onNaturalSortChanged();
     int           rowOfItem(const DirItemInfo &fi);
     QDir::Filters currentDirFilter()  const;
+    QDir::Filters listingDirFilter()  const;
     QString       dirItems(const DirItemInfo &fi) const;
+    void          queueItemStat(const DirItemInfo &fi) const;
+    bool          requestPendingItemStats();
+    void          addItemStatResolver(const DirItemInfoList &items, bool reorderWhenDone);
     bool          cdIntoItem(const DirItemInfo &fi);
     bool          openItem(const DirItemInfo &fi);
     DirItemInfo   setParentIfRelative(const QString &fileOrDir) const;
     void          setPathFromCurrentLocation();
+    void          setCurrentLocation(Location *location);
 
 private:
     void          startExternalFsWatcher();
     void          stoptExternalFsWatcher();
     void          clear();
+    void          reload();
+    void          replayExternalChanges();
 
 private slots:
-    void          onItemAddedOutsideFm(const DirItemInfo &fi);
-    void          onItemRemovedOutSideFm(const DirItemInfo &);
-    void          onItemChangedOutSideFm(const DirItemInfo &fi);
+    void          onItemsChangedOutsideFm(const DirItemChangeSet &changes);
     void          onThereAreExternalChanges(const QString &);
+    void          onThereAreExternalEntryChanges(const QString &path, const QStringList &names);
     void          onExternalFsWorkerFinished(int);
+    void          requestChildCounts();
+    void          requestMimeTypesFromContent(int firstRow = 0);
+    void          requestItemStats();
+    void          requestAudioMetaData();
 
 
 private:
@@ -570,7 +660,7 @@ private:
     FileSystemAction    *m_fsAction;  //!< it does file system recursive remove/copy/move
     QString  fileSize(qint64 size)  const;
 #ifndef DO_NOT_USE_TAG_LIB
-    QVariant getAudioMetaData(const QFileInfo &fi, int role) const;
+    QVariant getAudioMetaData(const DirItemInfo &fi, int role) const;
 #endif
     QSet<QString> m_allowedDirs;
 
@@ -585,6 +675,33 @@ private:
 
     bool allowAccess(const DirItemInfo &fi) const;
     bool allowCurrentPathAccess() const;
+
+private:
+    QString  listingCacheKey() const;
+    void     storeListingSnapshot();
+    bool     fillFromListingCache();
+    QString   mListingCacheKey;     //!< \ref DirListingCache key of the current listing, empty when it is not cached
+    QDateTime mCurrentDirModified;  //!< modification time of the current directory when it was listed
+    mutable QHash<QString, int> mChildCounts;      //!< items of each directory in the listing, -1 while it is counted
+    mutable QStringList  mChildCountsQueue;        //!< directories waiting for \ref requestChildCounts()
+    mutable DirItemInfoList mAudioMetaDataQueue;   //!< files waiting for \ref requestAudioMetaData()
+    mutable QSet<QString>   mAudioMetaDataRequested;
+    mutable DirItemInfoList mItemStatQueue;        //!< rows of a lazy listing waiting for \ref requestItemStats()
+    mutable QSet<QString>   mItemStatRequested;
+    IORequestCancelToken mListingToken;            //!< background work on the current listing, cancelled by \ref clear()
+    int             mFetchPageSize;     //!< rows exposed by each \ref fetchMore(), 0 exposes all rows
+    DirItemInfoList mPendingContents;   //!< items not exposed yet, they all sort after the last row
+    int             mPendingFirst;      //!< items before it in \ref mPendingContents were already exposed
+    bool            mPendingSorted;     //!< false when items were appended to \ref mPendingContents out of order
+    bool            mDiffRefresh;       //!< a refresh is reading the directory while the current rows stay
+    DirItemInfoList mRefreshedContents; //!< items read by that refresh, see \ref applyRefreshedContents()
+    DirItemInfoList mAddedWhileRefreshing; //!< items added while that refresh reads, the read may have missed them
+    DirItemInfoList mListing;           //!< every item read for the current path sorted by path, rows are the ones \ref acceptsItem()
+    bool            mListingSorted;     //!< false when items were appended to \ref mListing out of order, see \ref sortListing()
+    QSet<QString>   mQueuedPathChanges; //!< paths modified outside while awaiting results
+    QHash<QString, QSet<QString> > mQueuedEntryChanges; //!< entries modified outside while awaiting results, by path
+    DirItemRowIndex mPendingIndex;  //!< used by \ref pendingIndexOf()
+    DirItemRowIndex mRowIndex;      //!< used by \ref rowOfItem()
 };
 
 
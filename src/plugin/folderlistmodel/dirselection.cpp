@@ -23,10 +23,14 @@
 #include "diritemabstractlistmodel.h"
 #include <QTimer>
 #include <QDebug>
+#include <QtAlgorithms>
 
 
 #define  VALID_INDEX(index)   (index >= 0 && index < m_model->rowCount())
 
+#define  BITS_PER_WORD        64
+#define  ALL_BITS             (~Q_UINT64_C(0))
+
 DirSelection::DirSelection(QObject *parent) :  QObject(parent)
 {
 }
@@ -38,7 +42,16 @@ DirSelection::DirSelection(DirItemAbstractListModel *parent, DirItemInfoList *li
     , m_listItems(listItems)
     , m_mode(Single)
     , m_lastSelectedItem(-1)
+    , m_rows(0)
 {
+    resizeBits(m_listItems->count());
+
+    connect(m_model, &QAbstractItemModel::rowsInserted,  this, &DirSelection::onRowsInserted);
+    connect(m_model, &QAbstractItemModel::rowsRemoved,   this, &DirSelection::onRowsRemoved);
+    connect(m_model, &QAbstractItemModel::modelAboutToBeReset,    this, &DirSelection::saveSelectedPaths);
+    connect(m_model, &QAbstractItemModel::modelReset,             this, &DirSelection::restoreSelectedPaths);
+    connect(m_model, &QAbstractItemModel::layoutAboutToBeChanged, this, &DirSelection::saveSelectedPaths);
+    connect(m_model, &QAbstractItemModel::layoutChanged,          this, &DirSelection::restoreSelectedPaths);
 }
 
 
@@ -46,11 +59,9 @@ DirSelection::DirSelection(DirItemAbstractListModel *parent, DirItemInfoList *li
 QStringList DirSelection::selectedAbsFilePaths() const
 {
     QStringList ret;
-    int counter = m_model->rowCount();
-    for (int index = 0 ; index < counter; ++index) {
-        if (m_listItems->at(index).isSelected()) {
-            ret.append(m_listItems->at(index).absoluteFilePath());
-        }
+    ret.reserve(m_selectedCounter);
+    for (int index = nextSelected(0); index >= 0; index = nextSelected(index + 1)) {
+        ret.append(m_listItems->at(index).absoluteFilePath());
     }
     return ret;
 }
@@ -58,11 +69,9 @@ QStringList DirSelection::selectedAbsFilePaths() const
 QStringList DirSelection::selectedNames() const
 {
     QStringList ret;
-    int counter = m_model->rowCount();
-    for (int index = 0 ; index < counter; ++index) {
-        if (m_listItems->at(index).isSelected()) {
-            ret.append(m_listItems->at(index).fileName());
-        }
+    ret.reserve(m_selectedCounter);
+    for (int index = nextSelected(0); index >= 0; index = nextSelected(index + 1)) {
+        ret.append(m_listItems->at(index).fileName());
     }
     return ret;
 }
@@ -72,11 +81,9 @@ QStringList DirSelection::selectedNames() const
 QList<int>  DirSelection::selectedIndexes()    const
 {
     QList<int> ret;
-    int counter = m_model->rowCount();
-    for (int index = 0 ; index < counter; ++index) {
-        if (m_listItems->at(index).isSelected()) {
-            ret.append(index);
-        }
+    ret.reserve(m_selectedCounter);
+    for (int index = nextSelected(0); index >= 0; index = nextSelected(index + 1)) {
+        ret.append(index);
     }
     return ret;
 }
@@ -94,14 +101,7 @@ bool DirSelection::priv_clear()
 {
     bool notify = m_selectedCounter != 0;
     if (notify) {
-        int counter = m_model->rowCount();
-        DirItemInfo *data =  m_listItems->data();
-        while (m_selectedCounter > 0  && counter-- ) {
-            if ( data[counter].setSelection(false) ) {
-                --m_selectedCounter;
-                m_model->notifyItemChanged(counter);
-            }
-        }
+        priv_setRange(0, m_rows - 1, false, true);
     }
     //force it to zero, works when cleaning the buffer first
     m_selectedCounter  = 0;
@@ -112,16 +112,7 @@ bool DirSelection::priv_clear()
 
 void DirSelection::selectAll()
 {
-    int counter = m_model->rowCount();
-    bool notify = m_selectedCounter != counter;
-    if (notify) {
-        DirItemInfo *data =  m_listItems->data();
-        while ( counter-- ) {
-            if ( data[counter].setSelection(true) ) {
-                ++m_selectedCounter;
-                m_model->notifyItemChanged(counter);
-            }
-        }
+    if (m_selectedCounter != m_rows && priv_setRange(0, m_rows - 1, true, true) > 0) {
         notifyChanges();
     }
 }
@@ -144,13 +135,10 @@ DirSelection::Mode DirSelection::mode() const
 }
 
 
-void DirSelection::itemGoingToBeRemoved(const DirItemInfo &item)
+bool DirSelection::isIndexSelected(int index) const
 {
-    if (m_selectedCounter > 0 && item.isSelected()) {
-        --m_selectedCounter;
-        notifyChanges();
-    }
-    // item is going to be removed, no QAbstractItemModel::dataChanged() signal is necessary to refresh views
+    return index >= 0 && index < m_rows
+           && (m_bits.at(index / BITS_PER_WORD) & (Q_UINT64_C(1) << (index % BITS_PER_WORD)));
 }
 
 
@@ -173,7 +161,7 @@ void DirSelection::setIndex(int index, bool selected)
 void DirSelection::toggleIndex(int index)
 {
     if (VALID_INDEX(index)) {
-        setIndex(index, !m_listItems->at(index).isSelected());
+        setIndex(index, !isIndexSelected(index));
     }
 }
 
@@ -193,62 +181,228 @@ void DirSelection::notifyChanges()
 }
 
 
+void DirSelection::selectRange(int indexClicked)
+{
+    if (   VALID_INDEX(indexClicked)
+            && m_selectedCounter > 0
+            && indexClicked != m_lastSelectedItem
+            && VALID_INDEX(m_lastSelectedItem)
+            && !isIndexSelected(indexClicked)
+       ) {
+        //go from indexClicked to  m_lastSelectedItem, stopping at the first item already selected
+        int  increment = indexClicked > m_lastSelectedItem ?  -1 : 1;
+        int  lastItem  = indexClicked;
+        while (lastItem != m_lastSelectedItem && !isIndexSelected(lastItem + increment)) {
+            lastItem += increment;
+        }
+        if (priv_setRange(qMin(indexClicked, lastItem), qMax(indexClicked, lastItem), true, true) > 0) {
+            m_lastSelectedItem = lastItem;
+            notifyChanges();
+        }
+    }
+}
+
+
+bool DirSelection::priv_setIndex(int index, bool selected)
+{
+    bool changed = priv_setRange(index, index, selected, true) > 0;
+    if (changed && selected) {
+        m_lastSelectedItem = index;
+    }
+    return changed;
+}
+
+
 /*!
- * \brief DirSelection::itemGoingToBeReplaced() it is supposed to control selection writable and readabble states
+ * \brief DirSelection::priv_setRange() selects or unselects rows from \a first to \a last, both included
  *
- *     So far it does nothing
+ *  Works a word of the bitset at a time, rows that changed are notified in contiguous ranges.
  *
- * \param oldItemInfo
- * \param newItemInfo
+ * \return the number of rows that changed
  */
-void DirSelection::itemGoingToBeReplaced(const DirItemInfo &oldItemInfo,
-                                         const DirItemInfo &newItemInfo)
+int DirSelection::priv_setRange(int first, int last, bool selected, bool notifyRows)
 {
-    if (oldItemInfo.isSelected()) {
-        // we may add selection writable state in the future
-        Q_UNUSED(newItemInfo);
+    int changedRows = 0;
+    int rangeFirst  = -1;
+    int rangeLast   = -1;
+    const int firstWord = first / BITS_PER_WORD;
+    const int lastWord  = last  / BITS_PER_WORD;
+    for (int word = firstWord; word <= lastWord && first <= last; ++word) {
+        quint64 mask = ALL_BITS;
+        if (word == firstWord) {
+            mask &= ALL_BITS << (first % BITS_PER_WORD);
+        }
+        if (word == lastWord && last % BITS_PER_WORD != BITS_PER_WORD - 1) {
+            mask &= (Q_UINT64_C(1) << (last % BITS_PER_WORD + 1)) - 1;
+        }
+        const quint64 previous = m_bits.at(word);
+        m_bits[word] = selected ? previous | mask : previous & ~mask;
+        quint64 changed = previous ^ m_bits.at(word);
+        if (changed == 0) {
+            continue;
+        }
+        changedRows += qPopulationCount(changed);
+        if (!notifyRows) {
+            continue;
+        }
+        const int base = word * BITS_PER_WORD;
+        if (changed == ALL_BITS && rangeLast == base - 1) {
+            rangeLast = base + BITS_PER_WORD - 1;
+            continue;
+        }
+        while (changed) {
+            const int row = base + static_cast<int> (qCountTrailingZeroBits(changed));
+            changed &= changed - 1;
+            if (row != rangeLast + 1 || rangeFirst < 0) {
+                if (rangeFirst >= 0) {
+                    m_model->notifyItemsChanged(rangeFirst, rangeLast);
+                }
+                rangeFirst = row;
+            }
+            rangeLast = row;
+        }
+    }
+    if (rangeFirst >= 0) {
+        m_model->notifyItemsChanged(rangeFirst, rangeLast);
     }
+    m_selectedCounter += selected ? changedRows : -changedRows;
+    return changedRows;
 }
 
 
-void DirSelection::selectRange(int indexClicked)
+/*!
+ * \brief DirSelection::nextSelected() returns the first selected row from \a index on, -1 if there is none
+ */
+int DirSelection::nextSelected(int index) const
 {
-    bool changed = false;
-    if (   VALID_INDEX(indexClicked)
-            && m_selectedCounter > 0
-            && indexClicked != m_lastSelectedItem
-            && VALID_INDEX(m_lastSelectedItem)
-            && !m_listItems->at(indexClicked).isSelected()
-       ) {
-        //go from indexClicked to  m_lastSelectedItem
-        int  increment = indexClicked > m_lastSelectedItem ?  -1 : 1;
-        int  nextItem  = indexClicked;
-        int  saved_lastSelectedItem = m_lastSelectedItem;
-        while (priv_setIndex(nextItem, true) && nextItem != saved_lastSelectedItem) {
-            nextItem  += increment;
-            changed    = true;
+    if (index < 0 || index >= m_rows) {
+        return -1;
+    }
+    int word = index / BITS_PER_WORD;
+    quint64 bits = m_bits.at(word) & (ALL_BITS << (index % BITS_PER_WORD));
+    while (bits == 0) {
+        if (++word >= m_bits.count()) {
+            return -1;
         }
+        bits = m_bits.at(word);
+    }
+    return word * BITS_PER_WORD + static_cast<int> (qCountTrailingZeroBits(bits));
+}
+
+
+/*!
+ * \brief DirSelection::resizeBits() makes the bitset cover \a rows, rows beyond it are not selected
+ */
+void DirSelection::resizeBits(int rows)
+{
+    m_rows = rows;
+    m_bits.resize((rows + BITS_PER_WORD - 1) / BITS_PER_WORD);
+    if (rows % BITS_PER_WORD) {
+        m_bits.last() &= (Q_UINT64_C(1) << (rows % BITS_PER_WORD)) - 1;
+    }
+}
+
+
+void DirSelection::onRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    const int count = last - first + 1;
+    // selected rows after the new ones move down
+    QVector<int> moved;
+    for (int index = nextSelected(first); index >= 0; index = nextSelected(index + 1)) {
+        moved.append(index);
+    }
+    if (!moved.isEmpty()) {
+        priv_setRange(first, m_rows - 1, false, false);
+    }
+    resizeBits(m_rows + count);
+    foreach (int index, moved) {
+        m_bits[(index + count) / BITS_PER_WORD] |= Q_UINT64_C(1) << ((index + count) % BITS_PER_WORD);
+    }
+    m_selectedCounter += moved.count();
+
+    if (m_lastSelectedItem >= first) {
+        m_lastSelectedItem += count;
+    }
+}
+
+
+void DirSelection::onRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    Q_UNUSED(parent);
+    const int count = last - first + 1;
+    const int previousCounter = m_selectedCounter;
+    // selected rows after the removed ones move up
+    QVector<int> moved;
+    for (int index = nextSelected(last + 1); index >= 0; index = nextSelected(index + 1)) {
+        moved.append(index);
+    }
+    if (previousCounter > 0) {
+        priv_setRange(first, m_rows - 1, false, false);
     }
-    if (changed) {
+    resizeBits(m_rows - count);
+    foreach (int index, moved) {
+        m_bits[(index - count) / BITS_PER_WORD] |= Q_UINT64_C(1) << ((index - count) % BITS_PER_WORD);
+    }
+    m_selectedCounter += moved.count();
+
+    if (m_lastSelectedItem > last) {
+        m_lastSelectedItem -= count;
+    } else if (m_lastSelectedItem >= first) {
+        m_lastSelectedItem = -1;
+    }
+    // removed rows need no dataChanged(), views already dropped them
+    if (m_selectedCounter != previousCounter) {
         notifyChanges();
     }
 }
 
 
-bool DirSelection::priv_setIndex(int index, bool selected)
+/*!
+ * \brief DirSelection::saveSelectedPaths() keeps the selected items before rows are reset or reordered
+ */
+void DirSelection::saveSelectedPaths()
 {
-    DirItemInfo *data  = m_listItems->data();
-    bool changed = false;
-    if ((changed = data[index].setSelection(selected))) {
-        m_model->notifyItemChanged(index);
-        if (selected) {
-            ++m_selectedCounter;
-            m_lastSelectedItem = index;
-        } else {
-            --m_selectedCounter;
+    m_savedPaths.clear();
+    m_savedLastSelected.clear();
+    for (int index = nextSelected(0); index >= 0; index = nextSelected(index + 1)) {
+        m_savedPaths.insert(m_listItems->at(index).absoluteFilePath());
+    }
+    if (m_lastSelectedItem >= 0 && m_lastSelectedItem < m_listItems->count()) {
+        m_savedLastSelected = m_listItems->at(m_lastSelectedItem).absoluteFilePath();
+    }
+}
+
+
+/*!
+ * \brief DirSelection::restoreSelectedPaths() selects the rows of the items saved by \ref saveSelectedPaths()
+ *
+ *  Views read every row again after a reset or a layout change, so no dataChanged() is emitted.
+ */
+void DirSelection::restoreSelectedPaths()
+{
+    const int previousCounter = m_selectedCounter;
+    m_bits.fill(0);
+    resizeBits(m_listItems->count());
+    m_selectedCounter  = 0;
+    m_lastSelectedItem = -1;
+    if (!m_savedPaths.isEmpty() || !m_savedLastSelected.isEmpty()) {
+        for (int index = 0; index < m_rows; ++index) {
+            const QString &path = m_listItems->at(index).absoluteFilePath();
+            if (m_savedPaths.contains(path)) {
+                m_bits[index / BITS_PER_WORD] |= Q_UINT64_C(1) << (index % BITS_PER_WORD);
+                ++m_selectedCounter;
+            }
+            if (path == m_savedLastSelected) {
+                m_lastSelectedItem = index;
+            }
         }
     }
-    return changed;
+    m_savedPaths.clear();
+    m_savedLastSelected.clear();
+    if (m_selectedCounter != previousCounter) {
+        notifyChanges();
+    }
 }
 
 
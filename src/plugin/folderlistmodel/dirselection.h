@@ -26,10 +26,20 @@
 
 #include <QObject>
 #include <QStringList>
+#include <QVector>
+#include <QSet>
 
 
 class DirItemAbstractListModel;
+class QModelIndex;
 
+/*!
+ * \brief The DirSelection class keeps the selected rows of a \ref DirItemAbstractListModel
+ *
+ *  The selection is a bitset indexed by row, it follows inserted and removed rows;
+ *  resets and layout changes are followed by the path of the selected items.
+ *  Changes are notified as one dataChanged() per contiguous range of rows.
+ */
 class DirSelection : public QObject
 {
     Q_OBJECT
@@ -96,13 +106,21 @@ public:
     Q_INVOKABLE  void        select(int index, bool range, bool multiSelection );
 
 public:
-    void        itemGoingToBeRemoved(const DirItemInfo &item);
-    void        itemGoingToBeReplaced(const DirItemInfo &oldItemInfo, const DirItemInfo &newItemInfo);
+    bool        isIndexSelected(int index) const;
+
+private slots:
+    void        onRowsInserted(const QModelIndex &parent, int first, int last);
+    void        onRowsRemoved(const QModelIndex &parent, int first, int last);
+    void        saveSelectedPaths();
+    void        restoreSelectedPaths();
 
 private:
     bool        priv_clear();
     void        notifyChanges();
     bool        priv_setIndex(int index, bool selected);
+    int         priv_setRange(int first, int last, bool selected, bool notifyRows);
+    int         nextSelected(int index) const;
+    void        resizeBits(int rows);
 
 signals:
     void        selectionChanged(int);
@@ -114,6 +132,10 @@ private:
     DirItemInfoList           *m_listItems;
     Mode                       m_mode;
     int                        m_lastSelectedItem;
+    QVector<quint64>           m_bits;           //!< bit n is set when row n is selected
+    int                        m_rows;           //!< number of rows \a m_bits covers
+    QSet<QString>              m_savedPaths;     //!< selected items while the model is reset or reordered
+    QString                    m_savedLastSelected;
 };
 
 #endif // DIRSELECTION_H
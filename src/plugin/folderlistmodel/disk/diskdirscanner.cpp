@@ -0,0 +1,244 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: diskdirscanner.cpp
+ * Date: 17/10/2026
+ */
+
+#include "diskdirscanner.h"
+
+#include <QFile>
+#include <QDebug>
+
+#if defined(Q_OS_LINUX)
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#endif
+
+#if defined(Q_OS_LINUX) && defined(SYS_getdents64)
+# define HAS_GETDENTS64 1
+#else
+# define HAS_GETDENTS64 0
+#endif
+
+#if HAS_GETDENTS64
+namespace {
+/*!
+ * Kernel record filled by getdents64(), glibc does not export a wrapper for it
+ */
+struct LinuxDirent64 {
+    quint64        d_ino;
+    qint64         d_off;
+    unsigned short d_reclen;
+    unsigned char  d_type;
+    char           d_name[1];
+};
+}
+#endif
+
+
+DiskDirScanner::DiskDirScanner(QDir::Filters filter)
+    : m_filter(filter)
+    , m_dirFd(-1)
+    , m_bufferPos(0)
+    , m_bufferEnd(0)
+    , m_lastIsRealDir(false)
+    , m_lazyStat(false)
+#if defined(Q_OS_UNIX)
+    , m_uid(::geteuid())
+#else
+    , m_uid(0)
+#endif
+{
+}
+
+DiskDirScanner::~DiskDirScanner()
+{
+    close();
+}
+
+/*!
+ * \brief DiskDirScanner::isAvailable()
+ * \return true if getdents64() can be used on this platform
+ */
+bool DiskDirScanner::isAvailable()
+{
+    return HAS_GETDENTS64;
+}
+
+/*!
+ * \brief DiskDirScanner::open() opens the directory \a path, a previous directory is closed
+ * \return true if the directory could be opened
+ */
+bool DiskDirScanner::open(const QString &path)
+{
+    close();
+#if HAS_GETDENTS64
+    m_dirFd = ::open(QFile::encodeName(path).constData(),
+                     O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOCTTY);
+    if (m_dirFd != -1) {
+        m_path = path;
+        //the root dir is the only one that ends with slash
+        if (m_path.length() > 1 && m_path.endsWith(QDir::separator())) {
+            m_path.chop(1);
+        }
+        if (m_buffer.size() != DISK_DIR_SCANNER_BUFFER_SIZE) {
+            m_buffer.resize(DISK_DIR_SCANNER_BUFFER_SIZE);
+        }
+    }
+#else
+    Q_UNUSED(path);
+#endif
+    return m_dirFd != -1;
+}
+
+void DiskDirScanner::close()
+{
+#if HAS_GETDENTS64
+    if (m_dirFd != -1) {
+        ::close(m_dirFd);
+    }
+#endif
+    m_dirFd     = -1;
+    m_bufferPos = 0;
+    m_bufferEnd = 0;
+}
+
+/*!
+ * \brief DiskDirScanner::fillBuffer() reads the next block of entries
+ * \return false when there are no more entries or an error happened
+ */
+bool DiskDirScanner::fillBuffer()
+{
+#if HAS_GETDENTS64
+    long ret = ::syscall(SYS_getdents64, m_dirFd, m_buffer.data(), m_buffer.size());
+    if (ret <= 0) {
+        if (ret < 0) {
+            qWarning() << Q_FUNC_INFO << "getdents64() failed on" << m_path;
+        }
+        return false;
+    }
+    m_bufferPos = 0;
+    m_bufferEnd = static_cast<int> (ret);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool DiskDirScanner::acceptsName(const char *name) const
+{
+    if (name[0] == '.') {
+        // "." and ".." are never returned, \ref DirModel always uses QDir::NoDotAndDotDot
+        if (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')) {
+            return false;
+        }
+        if (!(m_filter & QDir::Hidden)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief DiskDirScanner::next() gets the next entry that matches the filter
+ * \param item it is set with the entry information
+ * \return false when there are no more entries
+ */
+bool DiskDirScanner::next(DirItemInfo &item)
+{
+#if HAS_GETDENTS64
+    const bool wantsDirs    = m_filter & (QDir::Dirs | QDir::AllDirs);
+    const bool wantsFiles   = m_filter & QDir::Files;
+    const bool wantsSystem  = m_filter & QDir::System;
+    const bool wantsLinks   = !(m_filter & QDir::NoSymLinks);
+
+    while (m_dirFd != -1) {
+        if (m_bufferPos >= m_bufferEnd && !fillBuffer()) {
+            close();
+            break;
+        }
+        const LinuxDirent64 *entry =
+            reinterpret_cast<const LinuxDirent64 *> (m_buffer.constData() + m_bufferPos);
+        m_bufferPos += entry->d_reclen;
+
+        if (!acceptsName(entry->d_name)) {
+            continue;
+        }
+
+        unsigned char type = entry->d_type;
+        // use d_type to discard entries before doing any stat
+        if ((type == DT_LNK && !wantsLinks) ||
+                (type == DT_DIR && !wantsDirs) ||
+                (type == DT_REG && !wantsFiles) ||
+                (type != DT_UNKNOWN && type != DT_LNK && type != DT_DIR && type != DT_REG && !wantsSystem)) {
+            continue;
+        }
+
+        // name and type are enough, the stat() is done later for the rows being shown
+        if (m_lazyStat && (type == DT_DIR || type == DT_REG)) {
+            m_lastIsRealDir = type == DT_DIR;
+            item = DirItemInfo();
+            item.setLocalFileFromDirEntry(m_path, QFile::decodeName(entry->d_name), m_lastIsRealDir);
+            return true;
+        }
+
+        bool isLink = type == DT_LNK;
+        struct stat st;
+        int flags = wantsLinks ? 0 : AT_SYMLINK_NOFOLLOW;
+        bool isBrokenLink = false;
+        if (::fstatat(m_dirFd, entry->d_name, &st, flags) != 0) {
+            // broken link, QDir only returns it when QDir::System is set
+            if (!wantsSystem || ::fstatat(m_dirFd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                continue;
+            }
+            isBrokenLink = true;
+        }
+        if (type == DT_UNKNOWN) {
+            // some file systems do not fill d_type
+            if (S_ISLNK(st.st_mode)) {
+                if (!wantsLinks) {
+                    continue;
+                }
+                isLink = true;
+            } else if (wantsLinks) {
+                struct stat lst;
+                isLink = ::fstatat(m_dirFd, entry->d_name, &lst, AT_SYMLINK_NOFOLLOW) == 0
+                         && S_ISLNK(lst.st_mode);
+            }
+        }
+
+        bool isDir  = S_ISDIR(st.st_mode);
+        bool isFile = S_ISREG(st.st_mode);
+        if ((isDir && !wantsDirs) || (isFile && !wantsFiles) || (!isDir && !isFile && !wantsSystem)) {
+            continue;
+        }
+
+        m_lastIsRealDir = isDir && !isLink;
+        item = DirItemInfo();
+        item.setLocalFileFromStatBuf(m_path, QFile::decodeName(entry->d_name),
+                                     st, isLink, isBrokenLink ? 0 :
+                                     DirItemInfo::localFileAccess(m_dirFd, entry->d_name, st, m_uid));
+        return true;
+    }
+#else
+    Q_UNUSED(item);
+#endif
+    return false;
+}
@@ -27,6 +27,7 @@
 #include "locationurl.h"
 #include "disklocationitemfile.h"
 #include "disklocationitemdir.h"
+#include "diskdirscanner.h"
 
 
 #if defined(Q_OS_UNIX)
@@ -45,6 +46,7 @@
 DiskLocation::DiskLocation(int type, QObject *parent)
     : Location(type, parent)
     , m_extWatcher(0)
+    , m_useNativeScanner(DiskDirScanner::isAvailable())
 {
 }
 
@@ -77,6 +79,11 @@ void DiskLocation::startExternalFsWatcher()
 
         connect(m_extWatcher, SIGNAL(pathModified(QString)),
                 this,         SIGNAL(extWatcherPathChanged(QString)));
+
+        // only the entries inotify reports are checked, see fetchExternalEntryChanges()
+        m_extWatcher->setReportsEntries(true);
+        connect(m_extWatcher, SIGNAL(entriesModified(QString, QStringList)),
+                this,         SIGNAL(extWatcherEntriesChanged(QString, QStringList)));
     }
 
     if (m_extWatcher && m_info) {
@@ -109,23 +116,46 @@ void DiskLocation::stopWorking()
 void DiskLocation::fetchExternalChanges(const QString &path, const DirItemInfoList &list, QDir::Filters dirFilter)
 {
     auto extFsWorker = new ExternalFileSystemChangesWorker(list, path, dirFilter, false);
+    extFsWorker->setNativeScanner(m_useNativeScanner);
 
     addExternalFsWorkerRequest(extFsWorker);
 }
 
-void DiskLocation::addExternalFsWorkerRequest(ExternalFileSystemChangesWorker *extFsWorker)
+/*!
+ * \brief DiskLocation::fetchExternalEntryChanges() checks only the entries \a names of \a path
+ *
+ *  \a list has the items of the current listing for those names, the directory is not read.
+ */
+void DiskLocation::fetchExternalEntryChanges(const QString &path, const QStringList &names,
+                                             const DirItemInfoList &list, QDir::Filters dirFilter)
 {
-    connect(extFsWorker,    SIGNAL(added(DirItemInfo)),
-            this,           SIGNAL(extWatcherItemAdded(DirItemInfo)));
+    addExternalFsWorkerRequest(new ExternalFileSystemEntriesWorker(list, path, names, dirFilter));
+}
 
-    connect(extFsWorker,    SIGNAL(removed(DirItemInfo)),
-            this,           SIGNAL(extWatcherItemRemoved(DirItemInfo)));
+/*!
+ * \brief DiskLocation::addExternalFsWorkerRequest() queues a compare of the current listing
+ *
+ *  The worker belongs to the current fetch, changes are not relayed once the Location
+ *  browses another path, see \ref cancelFetch()
+ */
+void DiskLocation::addExternalFsWorkerRequest(ExternalFileSystemChangesWorker *extFsWorker)
+{
+    const IORequestCancelToken token = m_fetchToken;
+    extFsWorker->setCancelToken(token);
 
-    connect(extFsWorker,    SIGNAL(changed(DirItemInfo)),
-            this,           SIGNAL(extWatcherItemChanged(DirItemInfo)));
+    extFsWorker->setSortFunction(m_sortFunction);
 
-    connect(extFsWorker,    SIGNAL(finished(int)),
-            this,           SIGNAL(extWatcherChangesFetched(int)));
+    connect(extFsWorker, &ExternalFileSystemChangesWorker::changesFound, this,
+    [this, token](const DirItemChangeSet & changes) {
+        if (!token.isCancelled()) {
+            emit extWatcherChangesFound(changes);
+        }
+    });
+    connect(extFsWorker, &ExternalFileSystemChangesWorker::finished, this, [this, token](int remainingItems) {
+        if (!token.isCancelled()) {
+            emit extWatcherChangesFetched(remainingItems);
+        }
+    });
 
     workerThread()->addRequest(extFsWorker);
 }
@@ -152,7 +182,24 @@ DirItemInfo *DiskLocation::newItemInfo(const QString &urlPath)
 DirListWorker *DiskLocation::newListWorker(const QString &urlPath, QDir::Filters filter,
                                            const bool isRecursive)
 {
-    return new DirListWorker(urlPath, filter, isRecursive);
+    DirListWorker *worker = new DirListWorker(urlPath, filter, isRecursive);
+    worker->setNativeScanner(m_useNativeScanner);
+    return worker;
+}
+
+/*!
+ * \brief DiskLocation::setUseNativeScanner() chooses between \ref DiskDirScanner and QDirIterator to list folders
+ *
+ *  \ref DiskDirScanner is the default when it is available.
+ */
+void DiskLocation::setUseNativeScanner(bool use)
+{
+    m_useNativeScanner = use && DiskDirScanner::isAvailable();
+}
+
+bool DiskLocation::usesNativeScanner() const
+{
+    return m_useNativeScanner;
 }
 
 QString DiskLocation::urlBelongsToLocation(const QString &urlPath, int indexOfColonAndSlash)
@@ -50,6 +50,8 @@ public:
     ExternalFSWatcher *getExternalFSWatcher() const;
 
     virtual void fetchExternalChanges(const QString &urlPath, const DirItemInfoList &list, QDir::Filters dirFilter) ;
+    virtual void fetchExternalEntryChanges(const QString &urlPath, const QStringList &names,
+                                           const DirItemInfoList &list, QDir::Filters dirFilter);
 
     virtual void startExternalFsWatcher();
     virtual void stopExternalFsWatcher();
@@ -69,6 +71,9 @@ public:
     virtual bool isThereDiskSpace(const QString &pathname, qint64 requiredSize);
     virtual QString urlBelongsToLocation(const QString &urlPath, int indexOfColonAndSlash);
 
+    void setUseNativeScanner(bool use);
+    bool usesNativeScanner() const;
+
 protected:
     void addExternalFsWorkerRequest(ExternalFileSystemChangesWorker *);
 
@@ -80,6 +85,7 @@ protected slots:
 
 protected:
     ExternalFSWatcher *m_extWatcher ;
+    bool               m_useNativeScanner; //!< list local folders using \ref DiskDirScanner
 
 };
 
@@ -0,0 +1,263 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: diskparallelscanner.cpp
+ * Date: 17/10/2026
+ */
+
+#include "diskparallelscanner.h"
+#include "diskdirscanner.h"
+
+#include <QDirIterator>
+#include <QMutexLocker>
+
+/*!
+ * \brief The DiskParallelScannerThread class is a single thread of a \ref DiskParallelScanner
+ */
+class DiskParallelScannerThread : public QThread
+{
+public:
+    DiskParallelScannerThread(DiskParallelScanner *owner, int index)
+        : QThread()
+        , m_owner(owner)
+        , m_index(index)
+        , m_scanner(owner->m_filter)
+    {
+    }
+
+    void run()
+    {
+        DirItemInfoList local;
+        QString dir;
+        while (!m_owner->m_stop.load()) {
+            if (!m_owner->popWork(m_index, dir)) {
+                // other threads are still reading and may push new directories
+                if (!m_owner->waitForWork()) {
+                    break;
+                }
+                continue;
+            }
+            if (m_owner->m_useNativeScanner) {
+                readWithScanner(dir, local);
+            } else {
+                readWithIterator(dir, local);
+            }
+            if (local.count() >= DISK_PARALLEL_SCAN_CHUNK_SIZE) {
+                m_owner->publish(local);
+            }
+            m_owner->workDone();
+        }
+        m_owner->publish(local);
+        m_owner->threadFinished();
+    }
+
+private:
+    void readWithScanner(const QString &dir, DirItemInfoList &local)
+    {
+        if (m_scanner.open(dir)) {
+            DirItemInfo item;
+            while (m_scanner.next(item)) {
+                if (m_scanner.lastIsRealDir()) {
+                    m_owner->pushWork(m_index, item.absoluteFilePath());
+                } else {
+                    local.append(item);
+                }
+            }
+        }
+    }
+
+    void readWithIterator(const QString &dir, DirItemInfoList &local)
+    {
+        QDirIterator it(QDir(dir, QString(), QDir::NoSort, m_owner->m_filter));
+        while (it.hasNext()) {
+            it.next();
+            // links are listed, not followed, a link to an ancestor would never end
+            if (it.fileInfo().isDir() && !it.fileInfo().isSymLink()) {
+                m_owner->pushWork(m_index, it.fileInfo().filePath());
+            } else {
+                local.append(DirItemInfo(it.fileInfo()));
+            }
+        }
+    }
+
+private:
+    DiskParallelScanner *m_owner;
+    int                  m_index;
+    DiskDirScanner       m_scanner;  //!< keeps its buffer for every directory this thread reads
+};
+
+
+DiskParallelScanner::DiskParallelScanner(QDir::Filters filter, bool useNativeScanner, int threads)
+    : m_filter(filter)
+    , m_useNativeScanner(useNativeScanner && DiskDirScanner::isAvailable())
+    , m_pendingDirs(0)
+    , m_queuedDirs(0)
+    , m_stop(0)
+    , m_runningThreads(0)
+{
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > DISK_PARALLEL_SCAN_MAX_THREADS) {
+        threads = DISK_PARALLEL_SCAN_MAX_THREADS;
+    }
+    for (int counter = 0; counter < threads; ++counter) {
+        m_queues.append(new WorkQueue);
+        m_threads.append(new DiskParallelScannerThread(this, counter));
+    }
+}
+
+DiskParallelScanner::~DiskParallelScanner()
+{
+    stop();
+    qDeleteAll(m_threads);
+    qDeleteAll(m_queues);
+}
+
+/*!
+ * \brief DiskParallelScanner::start() starts reading \a rootPath and all its sub directories
+ */
+void DiskParallelScanner::start(const QString &rootPath)
+{
+    m_pendingDirs.ref();
+    m_queuedDirs.ref();
+    m_queues.first()->dirs.append(rootPath);
+    m_runningThreads = m_threads.count();
+    foreach (DiskParallelScannerThread *thread, m_threads) {
+        // the caller waits on the results, idle threads would be starved by any other work
+        thread->start(QThread::LowPriority);
+    }
+}
+
+/*!
+ * \brief DiskParallelScanner::stop() makes all threads quit as soon as possible and waits for them
+ */
+void DiskParallelScanner::stop()
+{
+    m_stop.store(1);
+    {
+        QMutexLocker lock(&m_workMutex);
+        m_workAvailable.wakeAll();
+    }
+    foreach (DiskParallelScannerThread *thread, m_threads) {
+        thread->wait();
+    }
+}
+
+/*!
+ * \brief DiskParallelScanner::takeResults() waits for items found by the threads
+ * \param results receives all items collected since the last call
+ * \return false when the scan is over and there are no more results
+ */
+bool DiskParallelScanner::takeResults(DirItemInfoList &results)
+{
+    results.clear();
+    QMutexLocker lock(&m_resultsMutex);
+    while (m_results.isEmpty() && m_runningThreads > 0) {
+        m_resultsReady.wait(&m_resultsMutex);
+    }
+    if (m_results.isEmpty()) {
+        return false;
+    }
+    QList<DirItemInfoList> chunks;
+    chunks.swap(m_results);
+    lock.unlock();
+
+    foreach (const DirItemInfoList &chunk, chunks) {
+        results += chunk;
+    }
+    return true;
+}
+
+/*!
+ * \brief DiskParallelScanner::popWork() takes work from the own deque back, or steals from the others' front
+ */
+bool DiskParallelScanner::popWork(int threadIndex, QString &dir)
+{
+    WorkQueue *own = m_queues.at(threadIndex);
+    {
+        QMutexLocker lock(&own->mutex);
+        if (!own->dirs.isEmpty()) {
+            dir = own->dirs.takeLast();
+            m_queuedDirs.deref();
+            return true;
+        }
+    }
+    const int count = m_queues.count();
+    for (int counter = 1; counter < count; ++counter) {
+        WorkQueue *victim = m_queues.at((threadIndex + counter) % count);
+        QMutexLocker lock(&victim->mutex);
+        if (!victim->dirs.isEmpty()) {
+            dir = victim->dirs.takeFirst();
+            m_queuedDirs.deref();
+            return true;
+        }
+    }
+    return false;
+}
+
+void DiskParallelScanner::pushWork(int threadIndex, const QString &dir)
+{
+    m_pendingDirs.ref();
+    WorkQueue *own = m_queues.at(threadIndex);
+    {
+        QMutexLocker lock(&own->mutex);
+        own->dirs.append(dir);
+    }
+    QMutexLocker lock(&m_workMutex);
+    m_queuedDirs.ref();
+    m_workAvailable.wakeOne();
+}
+
+/*!
+ * \brief DiskParallelScanner::waitForWork() blocks an idle thread until a directory is queued
+ * \return false when the scan is over or stopped
+ */
+bool DiskParallelScanner::waitForWork()
+{
+    QMutexLocker lock(&m_workMutex);
+    while (!m_stop.load() && m_pendingDirs.load() > 0 && m_queuedDirs.load() <= 0) {
+        m_workAvailable.wait(&m_workMutex);
+    }
+    return !m_stop.load() && m_pendingDirs.load() > 0;
+}
+
+/*!
+ * \brief DiskParallelScanner::workDone() called when a directory was read, the last one wakes all idle threads
+ */
+void DiskParallelScanner::workDone()
+{
+    if (!m_pendingDirs.deref()) {
+        QMutexLocker lock(&m_workMutex);
+        m_workAvailable.wakeAll();
+    }
+}
+
+void DiskParallelScanner::publish(DirItemInfoList &items)
+{
+    if (!items.isEmpty()) {
+        QMutexLocker lock(&m_resultsMutex);
+        m_results.append(items);
+        items.clear();
+        m_resultsReady.wakeOne();
+    }
+}
+
+void DiskParallelScanner::threadFinished()
+{
+    QMutexLocker lock(&m_resultsMutex);
+    --m_runningThreads;
+    m_resultsReady.wakeOne();
+}
@@ -0,0 +1,99 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: diskparallelscanner.h
+ * Date: 17/10/2026
+ */
+
+#ifndef DISKPARALLELSCANNER_H
+#define DISKPARALLELSCANNER_H
+
+#include "diriteminfo.h"
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QStringList>
+#include <QList>
+
+/*!
+ *  Number of items a scanner thread collects before handing them to the caller
+ */
+#define DISK_PARALLEL_SCAN_CHUNK_SIZE   256
+
+/*!
+ *  Maximum number of threads used by a recursive scan
+ */
+#define DISK_PARALLEL_SCAN_MAX_THREADS  8
+
+class DiskParallelScannerThread;
+
+/*!
+ * \brief The DiskParallelScanner class lists a local directory tree using several threads
+ *
+ *  Each thread owns a deque of directories to read, it takes work from the back of its own deque
+ *  and when it runs out of work it steals from the front of the other threads' deques.
+ *  Sub directories found are pushed into the deque of the thread that found them.
+ *
+ *  Items are collected in a per thread buffer and handed to the caller in chunks by \ref takeResults(),
+ *  so the caller (the \ref IORequestLoader thread) is the only one that touches the final list.
+ *
+ *  Directories are not added to the results, it matches \ref IORequestLoader::add() recursive mode.
+ */
+class DiskParallelScanner
+{
+public:
+    DiskParallelScanner(QDir::Filters filter, bool useNativeScanner,
+                        int threads = QThread::idealThreadCount());
+    ~DiskParallelScanner();
+
+    void start(const QString &rootPath);
+    bool takeResults(DirItemInfoList &results);
+    void stop();
+
+private:
+    bool popWork(int threadIndex, QString &dir);
+    void pushWork(int threadIndex, const QString &dir);
+    bool waitForWork();
+    void workDone();
+    void publish(DirItemInfoList &items);
+    void threadFinished();
+
+private:
+    struct WorkQueue {
+        QMutex       mutex;
+        QStringList  dirs;
+    };
+
+    QDir::Filters                       m_filter;
+    bool                                m_useNativeScanner;
+    QList<WorkQueue *>                  m_queues;
+    QList<DiskParallelScannerThread *>  m_threads;
+    QAtomicInt                          m_pendingDirs; //!< directories pushed and not read yet
+    QAtomicInt                          m_queuedDirs;  //!< directories pushed and not taken by a thread yet
+    QMutex                              m_workMutex;
+    QWaitCondition                      m_workAvailable;
+    QAtomicInt                          m_stop;
+    QMutex                              m_resultsMutex;
+    QWaitCondition                      m_resultsReady;
+    QList<DirItemInfoList>              m_results;
+    int                                 m_runningThreads;
+
+    friend class DiskParallelScannerThread;
+};
+
+#endif // DISKPARALLELSCANNER_H
@@ -23,8 +23,30 @@
 
 #include <QTimer>
 #include <QDateTime>
+#include <QSocketNotifier>
+#include <QFile>
 #include <QDebug>
 
+#if defined(Q_OS_LINUX)
+# include <sys/inotify.h>
+# include <unistd.h>
+# include <errno.h>
+# define HAS_INOTIFY 1
+#else
+# define HAS_INOTIFY 0
+#endif
+
+#if HAS_INOTIFY
+/*!
+ *  Events that change the entries of a watched directory
+ */
+# define INOTIFY_ENTRY_EVENTS  (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_CLOSE_WRITE)
+/*!
+ *  Events that make the watched directory itself go away
+ */
+# define INOTIFY_SELF_EVENTS   (IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)
+#endif
+
 #if DEBUG_EXT_FS_WATCHER
 # define DEBUG_FSWATCHER()    \
     qDebug() << "[extFsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz") \
@@ -43,9 +65,47 @@ ExternalFSWatcher::ExternalFSWatcher(QObject *parent) :
     , m_waitingEmitCounter(0)
     , m_msWaitTime(DEFAULT_NOTICATION_PERIOD)
     , m_lastChangedIndex(-1)
+    , m_inotifyFd(-1)
+    , m_inotifyNotifier(0)
+    , m_inotifyFireScheduled(false)
+    , m_reportsEntries(false)
 {
     connect(this,   SIGNAL(directoryChanged(QString)),
             this,   SLOT(slotDirChanged(QString)));
+
+#if HAS_INOTIFY
+    m_inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd != -1) {
+        m_inotifyNotifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+        connect(m_inotifyNotifier, SIGNAL(activated(int)), this, SLOT(slotInotifyEvents()));
+    }
+#endif
+}
+
+
+ExternalFSWatcher::~ExternalFSWatcher()
+{
+#if HAS_INOTIFY
+    if (m_inotifyFd != -1) {
+        delete m_inotifyNotifier;
+        ::close(m_inotifyFd);
+    }
+#endif
+}
+
+
+bool ExternalFSWatcher::usesInotify() const
+{
+    return m_inotifyFd != -1;
+}
+
+
+/*!
+ * \brief ExternalFSWatcher::setReportsEntries() when \a report is true inotify changes come in \ref entriesModified()
+ */
+void ExternalFSWatcher::setReportsEntries(bool report)
+{
+    m_reportsEntries = report;
 }
 
 
@@ -67,10 +127,28 @@ void ExternalFSWatcher::setCurrentPaths(const QStringList &paths)
         m_setPaths = paths;
     }
     clearPaths();
+    clearInotifyWatches();
     //cleaning m_changedPath avoids any notification for a change
     // already scheduled to happen in slotFireChanges()
     m_changedPath.clear();
-    QFileSystemWatcher::addPaths(m_setPaths);
+    m_fallbackPaths.clear();
+    foreach (const QString &path, m_setPaths) {
+#if HAS_INOTIFY
+        if (m_inotifyFd != -1) {
+            const QByteArray name = QFile::encodeName(path);
+            const int wd = ::inotify_add_watch(m_inotifyFd, name.constData(),
+                                               INOTIFY_ENTRY_EVENTS | INOTIFY_SELF_EVENTS | IN_ONLYDIR);
+            if (wd != -1) {
+                m_inotifyWatches.insert(wd, path);
+                continue;
+            }
+            // ENOSPC when the user watch limit is reached
+            DEBUG_FSWATCHER_MSG("inotify_add_watch() failed, errno:" << errno);
+        }
+#endif
+        m_fallbackPaths.append(path);
+    }
+    restorePaths();
     DEBUG_FSWATCHER();
 }
 
@@ -84,6 +162,107 @@ void ExternalFSWatcher::clearPaths()
 }
 
 
+/*!
+ * \brief ExternalFSWatcher::restorePaths() puts the paths inotify does not watch in QFileSystemWatcher
+ */
+void ExternalFSWatcher::restorePaths()
+{
+    if (m_fallbackPaths.count() > 0) {
+        QFileSystemWatcher::addPaths(m_fallbackPaths);
+    }
+}
+
+
+/*!
+ * \brief ExternalFSWatcher::clearInotifyWatches() removes all inotify watches and the changes not notified yet
+ */
+void ExternalFSWatcher::clearInotifyWatches()
+{
+#if HAS_INOTIFY
+    QHash<int, QString>::ConstIterator it = m_inotifyWatches.constBegin();
+    for ( ; it != m_inotifyWatches.constEnd(); ++it) {
+        ::inotify_rm_watch(m_inotifyFd, it.key());
+    }
+#endif
+    m_inotifyWatches.clear();
+    m_changedEntries.clear();
+    m_rescanPaths.clear();
+}
+
+
+/*!
+ * \brief ExternalFSWatcher::slotInotifyEvents() reads the pending inotify events
+ *
+ *  Names of changed entries are kept per path, a path whose names are lost (queue overflow)
+ *  or that went away is marked to be read again. The notification is scheduled
+ *  \ref getIntervalToNotifyChanges() milliseconds after the first event.
+ */
+void ExternalFSWatcher::slotInotifyEvents()
+{
+#if HAS_INOTIFY
+    char buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    bool changed = false;
+    ssize_t length;
+    while ((length = ::read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+        const char *ptr = buffer;
+        while (ptr < buffer + length) {
+            const struct inotify_event *event = reinterpret_cast<const struct inotify_event *> (ptr);
+            ptr += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                foreach (const QString &path, m_inotifyWatches) {
+                    m_rescanPaths.insert(path);
+                }
+                changed = true;
+                continue;
+            }
+            // events of watches already removed are ignored
+            const QString path = m_inotifyWatches.value(event->wd);
+            if (path.isEmpty()) {
+                continue;
+            }
+            if (event->mask & (INOTIFY_SELF_EVENTS | IN_IGNORED)) {
+                m_rescanPaths.insert(path);
+                changed = true;
+            } else if (event->len > 0 && event->name[0] != '\0') {
+                m_changedEntries[path].insert(QFile::decodeName(event->name));
+                changed = true;
+            }
+        }
+    }
+
+    if (changed && !m_inotifyFireScheduled) {
+        m_inotifyFireScheduled = true;
+        QTimer::singleShot(m_msWaitTime, this, SLOT(slotFireInotifyChanges()));
+    }
+#endif
+}
+
+
+/*!
+ * \brief ExternalFSWatcher::slotFireInotifyChanges() notifies the changes collected by \ref slotInotifyEvents()
+ */
+void ExternalFSWatcher::slotFireInotifyChanges()
+{
+    m_inotifyFireScheduled = false;
+    QHash<QString, QSet<QString> > entries;
+    entries.swap(m_changedEntries);
+    QSet<QString> rescan;
+    rescan.swap(m_rescanPaths);
+
+    // setCurrentPaths() called meanwhile discards the changes, both sets are empty then
+    foreach (const QString &path, m_setPaths) {
+        if (rescan.contains(path) || (!m_reportsEntries && entries.contains(path))) {
+            emit pathModified(path);
+            DEBUG_FSWATCHER_MSG("emit pathModified()" << path);
+        } else if (entries.contains(path)) {
+            emit entriesModified(path, entries.value(path).toList());
+            DEBUG_FSWATCHER_MSG("emit entriesModified()" << path << entries.value(path).count());
+        }
+    }
+}
+
+
 /*!
  * \brief ExternalFSWatcher::slotDirChanged() schedules a Disk change to be notified
  *
@@ -133,7 +312,7 @@ void ExternalFSWatcher::slotFireChanges()
         //restore the original m_setPaths list in QFileSystemWatcher anyway
         //it does not matter if the notification was fired or not.
         clearPaths();
-        QFileSystemWatcher::addPaths(m_setPaths);
+        restorePaths();
     }
 }
 
@@ -24,9 +24,12 @@
 
 #include <QFileSystemWatcher>
 #include <QStringList>
+#include <QHash>
+#include <QSet>
 
 #define DEFAULT_NOTICATION_PERIOD  500
 
+class QSocketNotifier;
 
 /*!
  * \brief The ExternalFSWatcher class watches for external changes in Disk emitting pathModified() signal.
@@ -47,13 +50,21 @@
  *       more than one path before the getIntervalToNotifyChanges() expires, only the LAST path modified
  *       will be notified as changed. It may possible that it goes to a loop if all the paths were modified,
  *       but the loop finishes when the last one from the list is modified.
+ *
+ *  On Linux paths are watched by inotify instead, which also gives the names of the entries that changed.
+ *  Every modified path is notified; when \ref setReportsEntries() was set the names come in
+ *  \ref entriesModified() and \ref pathModified() is only emitted when they are not known
+ *  (the inotify queue overflowed or the directory itself was removed or moved).
+ *  Paths inotify cannot watch use QFileSystemWatcher as described above.
  */
 class ExternalFSWatcher : public QFileSystemWatcher
 {
     Q_OBJECT
 public:
     explicit ExternalFSWatcher(QObject *parent = 0);
+    virtual ~ExternalFSWatcher();
     int      getIntervalToNotifyChanges() const;
+    bool     usesInotify() const;
 
     inline const QStringList &pathsWatched() const
     {
@@ -62,18 +73,24 @@ public:
 
 signals:
     void      pathModified(const QString &path);
+    void      entriesModified(const QString &path, const QStringList &names);
 
 public slots:
     void      setCurrentPath(const QString &curPath);
     void      setCurrentPaths(const QStringList &paths);
     void      setIntervalToNotifyChanges(int ms);
+    void      setReportsEntries(bool report);
 
 private slots:
     void      slotDirChanged(const QString &);
     void      slotFireChanges();
+    void      slotInotifyEvents();
+    void      slotFireInotifyChanges();
 
 private:
     void      clearPaths();
+    void      restorePaths();
+    void      clearInotifyWatches();
 
 private:
     QStringList m_setPaths;
@@ -81,6 +98,14 @@ private:
     unsigned    m_waitingEmitCounter;
     int         m_msWaitTime;
     int         m_lastChangedIndex;
+    QStringList m_fallbackPaths;        //!< paths watched by QFileSystemWatcher
+    int                            m_inotifyFd;
+    QSocketNotifier               *m_inotifyNotifier;
+    QHash<int, QString>            m_inotifyWatches;    //!< watch descriptor -> path
+    QHash<QString, QSet<QString> > m_changedEntries;    //!< names changed in each path, not notified yet
+    QSet<QString>                  m_rescanPaths;       //!< paths whose changed names are not known
+    bool                           m_inotifyFireScheduled;
+    bool                           m_reportsEntries;
 };
 
 #endif // EXTERNALFSWATCHER_H
@@ -38,8 +38,105 @@
 #include "diriteminfo.h"
 #include <QString>
 #include <QDateTime>
+#include <QCollator>
 #include <QDebug>
 
+#include <algorithm>
+#include <vector>
+
+/*!
+ * \brief isSorted() returns true if \a items are already in \a compare order, it costs a single pass
+ */
+bool isSorted(const DirItemInfoList &items, CompareFunction compare)
+{
+    for (int counter = 1; counter < items.count(); ++counter) {
+        if (compare(items.at(counter), items.at(counter - 1))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+ * \brief sortItems() stable sort of \a items using \a compare
+ *
+ *  \ref DirItemInfo::operator=() swaps the objects, so the sort is done on indexes
+ *  and the list is built again using the copy constructor.
+ */
+void sortItems(DirItemInfoList &items, CompareFunction compare)
+{
+    if (isSorted(items, compare)) {
+        return;
+    }
+    QVector<int> indexes(items.count());
+    for (int counter = 0; counter < indexes.count(); ++counter) {
+        indexes[counter] = counter;
+    }
+    sortIndexes(items, indexes, compare);
+    DirItemInfoList sorted;
+    sorted.reserve(items.count());
+    foreach (int index, indexes) {
+        sorted.append(items.at(index));
+    }
+    items.swap(sorted);
+}
+
+/*!
+ * \brief sortIndexes() stable sort of \a indexes, positions in \a items, using \a compare
+ *
+ *  Items do not keep collation keys, for the name orders the keys are created here
+ *  and dropped after the sort, so each name is collated once instead of on every comparison.
+ */
+void sortIndexes(const DirItemInfoList &items, QVector<int> &indexes, CompareFunction compare)
+{
+    if (compare != fileCompareAscending && compare != fileCompareDescending
+            && compare != fileCompareExists) {
+        std::stable_sort(indexes.begin(), indexes.end(), [&items, compare](int a, int b) {
+            return compare(items.at(a), items.at(b));
+        });
+        return;
+    }
+    // QCollatorSortKey has no default constructor
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(items.count());
+    for (int counter = 0; counter < items.count(); ++counter) {
+        keys.push_back(items.at(counter).nameSortKey());
+    }
+    std::stable_sort(indexes.begin(), indexes.end(), [&items, &keys, compare](int a, int b) {
+        const DirItemInfo &itemA = items.at(a);
+        const DirItemInfo &itemB = items.at(b);
+        if (itemA.isDir() != itemB.isDir()) {
+            return itemA.isDir();
+        }
+        int cmp = keys[a].compare(keys[b]);
+        if (compare == fileCompareDescending) {
+            return cmp > 0;
+        }
+        if (cmp == 0 && compare == fileCompareExists) {
+            cmp = itemA.absoluteFilePath().compare(itemB.absoluteFilePath());
+        }
+        return cmp < 0;
+    });
+}
+
+/*!
+ * \brief lowerBound() first position not before \a item in the sorted \a items, starting at \a from
+ *
+ *  Gallops from \a from before the binary search, sorted batches merged one item after the other
+ *  usually land close to the previous one and cost a few comparisons instead of log(count).
+ */
+int lowerBound(const DirItemInfoList &items, int from, const DirItemInfo &item, CompareFunction compare)
+{
+    int low  = from;
+    int step = 1;
+    while (low + step - 1 < items.count() && compare(items.at(low + step - 1), item)) {
+        low  += step;
+        step *= 2;
+    }
+    const int high = qMin(low + step - 1, items.count());
+    return std::lower_bound(items.constBegin() + low, items.constBegin() + high, item, compare)
+           - items.constBegin();
+}
 
 
 bool fileCompareExists(const DirItemInfo &a, const DirItemInfo &b)
@@ -50,7 +147,12 @@ bool fileCompareExists(const DirItemInfo &a, const DirItemInfo &b)
     if (b.isDir() && !a.isDir())
         return false;
 
-    bool ret = QString::localeAwareCompare(a.absoluteFilePath(), b.absoluteFilePath()) < 0;
+    // same order as fileCompareAscending(), the path only matters for items with the same name
+    int cmp = a.compareName(b);
+    if (cmp == 0) {
+        cmp = a.absoluteFilePath().compare(b.absoluteFilePath());
+    }
+    bool ret = cmp < 0;
 #if DEBUG_MESSAGES
     qDebug() <<  Q_FUNC_INFO << ret << a.absoluteFilePath() << b.absoluteFilePath();
 #endif
@@ -66,7 +168,7 @@ bool fileCompareAscending(const DirItemInfo &a, const DirItemInfo &b)
     if (b.isDir() && !a.isDir())
         return false;
 
-    return QString::localeAwareCompare(a.fileName(), b.fileName()) < 0;
+    return a.compareName(b) < 0;
 }
 
 
@@ -78,7 +180,7 @@ bool fileCompareDescending(const DirItemInfo &a, const DirItemInfo &b)
     if (b.isDir() && !a.isDir())
         return false;
 
-    return QString::localeAwareCompare(a.fileName(), b.fileName()) > 0;
+    return a.compareName(b) > 0;
 }
 
 
@@ -90,7 +192,7 @@ bool dateCompareDescending(const DirItemInfo &a, const DirItemInfo &b)
     if (b.isDir() && !a.isDir())
         return false;
 
-    return a.lastModified() > b.lastModified();
+    return a.lastModifiedMSecs() > b.lastModifiedMSecs();
 }
 
 
@@ -102,7 +204,7 @@ bool dateCompareAscending(const DirItemInfo &a, const DirItemInfo &b)
     if (b.isDir() && !a.isDir())
         return false;
 
-    return a.lastModified() < b.lastModified();
+    return a.lastModifiedMSecs() < b.lastModifiedMSecs();
 }
 
 bool sizeCompareDescending(const DirItemInfo &a, const DirItemInfo &b)
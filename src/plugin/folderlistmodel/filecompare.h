@@ -37,10 +37,18 @@
 #ifndef FILECOMPARE_H
 #define FILECOMPARE_H
 
+#include <QVector>
+
 class DirItemInfo;
+typedef QVector<DirItemInfo> DirItemInfoList;
 
 typedef bool  (*CompareFunction)(const DirItemInfo &a, const DirItemInfo &b);
 
+bool isSorted(const DirItemInfoList &items, CompareFunction compare);
+void sortItems(DirItemInfoList &items, CompareFunction compare);
+void sortIndexes(const DirItemInfoList &items, QVector<int> &indexes, CompareFunction compare);
+int  lowerBound(const DirItemInfoList &items, int from, const DirItemInfo &item, CompareFunction compare);
+
 bool fileCompareExists(const DirItemInfo &a, const DirItemInfo &b);
 bool fileCompareAscending(const DirItemInfo &a, const DirItemInfo &b);
 bool fileCompareDescending(const DirItemInfo &a, const DirItemInfo &b);
@@ -114,3 +114,28 @@ bool FMUtil::testThemeName(const QString &themeName)
 #endif
     return hasTheme;
 }
+
+
+/*!
+ * \brief FMUtil::fitSize() returns \a size reduced to fit \a bounds keeping the aspect ratio
+ *
+ *  A width or height not greater than 0 in \a bounds means that dimension is free,
+ *  \a size is never enlarged.
+ */
+QSize FMUtil::fitSize(const QSize &size, const QSize &bounds)
+{
+    QSize ret(size);
+    if (!ret.isValid() || ret.isEmpty()) {
+        return ret;
+    }
+    if (bounds.width() > 0 && bounds.height() > 0) {
+        if (ret.width() > bounds.width() || ret.height() > bounds.height()) {
+            ret.scale(bounds, Qt::KeepAspectRatio);
+        }
+    } else if (bounds.width() > 0 && ret.width() > bounds.width()) {
+        ret = QSize(bounds.width(), qMax(1, ret.height() * bounds.width() / ret.width()));
+    } else if (bounds.height() > 0 && ret.height() > bounds.height()) {
+        ret = QSize(qMax(1, ret.width() * bounds.height() / ret.height()), bounds.height());
+    }
+    return ret;
+}
@@ -23,6 +23,7 @@
 #define FMUTIL_H
 
 #include <QStringList>
+#include <QSize>
 #include <QMimeType>
 #include <QMimeDatabase>
 
@@ -37,6 +38,7 @@ public:
     {
         return m_triedThemeName;
     }
+    static QSize          fitSize(const QSize &size, const QSize &bounds);
 
 private:
     FMUtil();
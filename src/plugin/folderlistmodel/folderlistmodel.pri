@@ -2,13 +2,24 @@ SOURCES += $$PWD/dirmodel.cpp \
            $$PWD/iorequest.cpp \
            $$PWD/iorequestworker.cpp \
            $$PWD/ioworkerthread.cpp \
+           $$PWD/ioscheduler.cpp \
            $$PWD/filesystemaction.cpp \
            $$PWD/filecompare.cpp \
            $$PWD/externalfswatcher.cpp \
            $$PWD/clipboard.cpp \
            $$PWD/fmutil.cpp \
            $$PWD/dirselection.cpp \
+           $$PWD/dirlistingcache.cpp \
+           $$PWD/dirchildcounter.cpp \
+           $$PWD/mimetyperesolver.cpp \
+           $$PWD/itemstatresolver.cpp \
+           $$PWD/imageloader.cpp \
+           $$PWD/thumbnailprovider.cpp \
+           $$PWD/dirlistingsnapshot.cpp \
+           $$PWD/diritemrowindex.cpp \
+           $$PWD/namefiltermatcher.cpp \
            $$PWD/diriteminfo.cpp \
+           $$PWD/diriteminfostore.cpp \
            $$PWD/urliteminfo.cpp \
            $$PWD/location.cpp \
            $$PWD/locationsfactory.cpp \                    
@@ -24,14 +35,25 @@ HEADERS += $$PWD/dirmodel.h \
            $$PWD/iorequest.h \
            $$PWD/iorequestworker.h \
            $$PWD/ioworkerthread.h \
+           $$PWD/ioscheduler.h \
            $$PWD/filesystemaction.h \
            $$PWD/filecompare.h \
            $$PWD/externalfswatcher.h \
            $$PWD/clipboard.h \
            $$PWD/fmutil.h  \
            $$PWD/dirselection.h \          
+           $$PWD/dirlistingcache.h \
+           $$PWD/dirchildcounter.h \
+           $$PWD/mimetyperesolver.h \
+           $$PWD/itemstatresolver.h \
+           $$PWD/imageloader.h \
+           $$PWD/thumbnailprovider.h \
+           $$PWD/dirlistingsnapshot.h \
+           $$PWD/diritemrowindex.h \
+           $$PWD/namefiltermatcher.h \
            $$PWD/diritemabstractlistmodel.h \
            $$PWD/diriteminfo.h \
+           $$PWD/diriteminfostore.h \
            $$PWD/urliteminfo.h \           
            $$PWD/location.h \
            $$PWD/locationsfactory.h \                   
@@ -47,12 +69,16 @@ HEADERS += $$PWD/dirmodel.h \
 SOURCES += $$PWD/disk/disklocation.cpp \
            $$PWD/disk/disklocationitemdiriterator.cpp \
            $$PWD/disk/disklocationitemfile.cpp \
-           $$PWD/disk/disklocationitemdir.cpp
+           $$PWD/disk/disklocationitemdir.cpp \
+           $$PWD/disk/diskdirscanner.cpp \
+           $$PWD/disk/diskparallelscanner.cpp
 
 HEADERS += $$PWD/disk/disklocation.h \
            $$PWD/disk/disklocationitemdiriterator.h \
            $$PWD/disk/disklocationitemfile.h \
-           $$PWD/disk/disklocationitemdir.h
+           $$PWD/disk/disklocationitemdir.h \
+           $$PWD/disk/diskdirscanner.h \
+           $$PWD/disk/diskparallelscanner.h
 
 
 SOURCES += $$PWD/trash/qtrashdir.cpp      \
@@ -94,6 +120,8 @@ else {
 
 !contains (DEFINES, DO_NOT_USE_TAG_LIB) {
    LIBS += -ltag
-   SOURCES += $$PWD/imageprovider.cpp 
-   HEADERS += $$PWD/imageprovider.h 
+   SOURCES += $$PWD/imageprovider.cpp \
+              $$PWD/audiometadata.cpp
+   HEADERS += $$PWD/imageprovider.h \
+              $$PWD/audiometadata.h
 }
@@ -0,0 +1,62 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: imageloader.cpp
+ * Date: 17/10/2026
+ */
+
+#include "imageloader.h"
+#include "ioscheduler.h"
+#include "ioworkerthread.h"
+
+ImageLoader::ImageLoader(RequestType type)
+    : IORequest()
+{
+    m_type = type;
+}
+
+
+ImageLoaderResponse::ImageLoaderResponse(ImageLoader *loader, const QString &poolName)
+    : QQuickImageResponse()
+    , m_finished(false)
+{
+    loader->setCancelToken(m_token);
+    connect(loader, &ImageLoader::loaded, this, &ImageLoaderResponse::onLoaded);
+    IOScheduler::instance()->pool(poolName)->addRequest(loader);
+}
+
+QQuickTextureFactory *ImageLoaderResponse::textureFactory() const
+{
+    return QQuickTextureFactory::textureFactoryForImage(m_image);
+}
+
+void ImageLoaderResponse::cancel()
+{
+    m_token.cancel();
+    if (!m_finished) {
+        m_finished = true;
+        emit finished();
+    }
+}
+
+void ImageLoaderResponse::onLoaded(const QImage &image)
+{
+    if (!m_finished) {
+        m_image    = image;
+        m_finished = true;
+        emit finished();
+    }
+}
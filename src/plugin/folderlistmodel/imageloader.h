@@ -0,0 +1,69 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: imageloader.h
+ * Date: 17/10/2026
+ */
+
+#ifndef IMAGELOADER_H
+#define IMAGELOADER_H
+
+#include "iorequest.h"
+
+#include <QQuickImageProvider>
+#include <QImage>
+
+/*!
+ * \brief The ImageLoader class is the base of the requests that load an image for an \ref ImageLoaderResponse
+ *
+ *  Subclasses emit \ref loaded() from run(), a null image when there is nothing to show.
+ */
+class ImageLoader : public IORequest
+{
+    Q_OBJECT
+public:
+    explicit ImageLoader(RequestType type);
+
+signals:
+    void loaded(const QImage &image);
+};
+
+
+/*!
+ * \brief The ImageLoaderResponse class is the asynchronous answer of the image providers
+ *
+ *  It runs an \ref ImageLoader in an \ref IOScheduler pool. QML cancels it when the Image goes away,
+ *  for example a row scrolled out of the view, the loader is then dropped without being run
+ *  if it did not start yet.
+ */
+class ImageLoaderResponse : public QQuickImageResponse
+{
+    Q_OBJECT
+public:
+    ImageLoaderResponse(ImageLoader *loader, const QString &poolName);
+    QQuickTextureFactory *textureFactory() const;
+    void                  cancel();
+
+private slots:
+    void                  onLoaded(const QImage &image);
+
+private:
+    QImage                m_image;
+    IORequestCancelToken  m_token;
+    bool                  m_finished;
+};
+
+#endif // IMAGELOADER_H
@@ -39,6 +39,8 @@
 ****************************************************************************/
 
 #include "imageprovider.h"
+#include "ioscheduler.h"
+#include "fmutil.h"
 
 #ifndef DO_NOT_USE_TAG_LIB
 #include <taglib/attachedpictureframe.h>
@@ -49,50 +51,231 @@
 #include <QQmlEngine>
 #include <QtGlobal>
 #include <QPainter>
+#include <QBuffer>
+#include <QImageReader>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QDir>
+#include <QAtomicInt>
+#include <QDebug>
+
+namespace {
+/*!
+ *  The disk cache is trimmed after this number of new files
+ */
+const int coverArtTrimInterval = 64;
+QAtomicInt coverArtFilesWritten(0);
+}
 
 
-CoverArtImageProvider::CoverArtImageProvider() : QQuickImageProvider(QQuickImageProvider::Image) {}
+CoverArtLoader::CoverArtLoader(const QString &path, const QSize &bounds, const QString &cacheDir)
+    : ImageLoader(CoverArtLoad)
+    , m_path(path)
+    , m_bounds(bounds)
+    , m_cacheDir(cacheDir)
+{
+}
 
-QImage CoverArtImageProvider::requestImage(const QString &id, QSize *size,
-                                           const QSize &requestedSize)
+void CoverArtLoader::run()
 {
-    Q_UNUSED(size);
-    Q_UNUSED(requestedSize);
     QImage img;
-#ifndef DO_NOT_USE_TAG_LIB
-    TagLib::MPEG::File mp3(id.toStdString().c_str(), true, TagLib::MPEG::Properties::Fast);
-    TagLib::ID3v2::FrameList list = mp3.ID3v2Tag()->frameListMap()["APIC"];
-    if (!list.isEmpty()) {
-        TagLib::ID3v2::AttachedPictureFrame *Pic = static_cast<TagLib::ID3v2::AttachedPictureFrame *>
-                                                   (list.front());
-        img.loadFromData((const uchar *) Pic->picture().data(), Pic->picture().size());
-        img = img.scaled(45, 45);
+    QString indexFile;
+    QByteArray hash;
+    const QFileInfo info(m_path);
+    if (!m_cacheDir.isEmpty() && info.exists()) {
+        // a track not changed since its picture was hashed is not parsed again
+        indexFile = indexFileName(info);
+        QFile index(indexFile);
+        if (index.open(QFile::ReadOnly)) {
+            hash = index.read(COVER_ART_HASH_LENGTH);
+            if (hash.size() == COVER_ART_HASH_LENGTH) {
+                img.load(coverFileName(hash));
+            }
+        }
+    }
+    // no picture or one that could not be decoded is not tried again until the track changes
+    if (img.isNull() && hash != COVER_ART_FAILED && !isCancelled()) {
+        const QByteArray picture = readPicture(m_path);
+        if (!isCancelled()) {
+            QString cacheFile;
+            hash = QByteArray(COVER_ART_FAILED);
+            if (!picture.isEmpty()) {
+                const QByteArray pictureHash = QCryptographicHash::hash(picture, QCryptographicHash::Sha1).toHex();
+                if (!m_cacheDir.isEmpty()) {
+                    cacheFile = coverFileName(pictureHash);
+                    img.load(cacheFile);
+                }
+                if (img.isNull()) {
+                    img = decode(picture, m_bounds);
+                    if (!img.isNull() && !cacheFile.isEmpty()) {
+                        QDir().mkpath(m_cacheDir);
+                        if (img.save(cacheFile, "PNG")) {
+                            trimCache();
+                        }
+                    }
+                }
+                if (!img.isNull()) {
+                    hash = pictureHash;
+                }
+            }
+            if (!indexFile.isEmpty()) {
+                saveFile(indexFile, hash);
+            }
+        }
+    }
+    if (!isCancelled()) {
+        emit loaded(img);
     }
-#endif
-    return img;
 }
 
+/*!
+ * \brief CoverArtLoader::coverFileName() returns the cache file of the picture whose hash is \a hash at the current size
+ */
+QString CoverArtLoader::coverFileName(const QByteArray &hash) const
+{
+    return m_cacheDir + QDir::separator() + QString::fromLatin1(hash)
+           + QLatin1Char('-') + QString::number(m_bounds.width())
+           + QLatin1Char('x') + QString::number(m_bounds.height())
+           + QLatin1String(".png");
+}
 
-CoverArtFullImageProvider::CoverArtFullImageProvider() : QQuickImageProvider(
-        QQuickImageProvider::Image) {}
+/*!
+ * \brief CoverArtLoader::indexFileName() returns the file that keeps the picture hash of the track \a info
+ *
+ *  It is named after the path, size and modification time, so a changed track gets another name.
+ */
+QString CoverArtLoader::indexFileName(const QFileInfo &info) const
+{
+    QCryptographicHash key(QCryptographicHash::Sha1);
+    key.addData(QFile::encodeName(info.absoluteFilePath()));
+    key.addData(QByteArray::number(info.size()));
+    key.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    return m_cacheDir + QLatin1String("/index/") + QString::fromLatin1(key.result().toHex());
+}
 
-QImage CoverArtFullImageProvider::requestImage(const QString &id, QSize *size,
-                                               const QSize &requestedSize)
+/*!
+ * \brief CoverArtLoader::saveFile() writes \a contents into \a fileName, readers never see it half written
+ */
+void CoverArtLoader::saveFile(const QString &fileName, const QByteArray &contents)
 {
-    Q_UNUSED(size);
-    Q_UNUSED(requestedSize);
-    QImage img;
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (file.open(QFile::WriteOnly) && file.write(contents) == contents.size() && file.commit()) {
+        trimCache();
+    }
+}
+
+/*!
+ * \brief CoverArtLoader::readPicture() returns the encoded bytes of the first ID3v2 attached picture
+ */
+QByteArray CoverArtLoader::readPicture(const QString &path)
+{
+    QByteArray ret;
 #ifndef DO_NOT_USE_TAG_LIB
-    TagLib::MPEG::File mp3(id.toStdString().c_str(), true, TagLib::MPEG::Properties::Fast);
-    TagLib::ID3v2::FrameList list = mp3.ID3v2Tag()->frameListMap()["APIC"];
-    if (!list.isEmpty()) {
-        TagLib::ID3v2::AttachedPictureFrame *Pic = static_cast<TagLib::ID3v2::AttachedPictureFrame *>
-                                                   (list.front());
-        img.loadFromData((const uchar *) Pic->picture().data(), Pic->picture().size());
-        img = img.scaled(300, 300);
+    // audio properties are not needed
+    TagLib::MPEG::File mp3(QFile::encodeName(path).constData(), false);
+    if (mp3.isValid() && mp3.ID3v2Tag()) {
+        TagLib::ID3v2::FrameList list = mp3.ID3v2Tag()->frameListMap()["APIC"];
+        if (!list.isEmpty()) {
+            TagLib::ID3v2::AttachedPictureFrame *pic =
+                static_cast<TagLib::ID3v2::AttachedPictureFrame *> (list.front());
+            ret = QByteArray(pic->picture().data(), static_cast<int> (pic->picture().size()));
+        }
     }
+#else
+    Q_UNUSED(path);
 #endif
-    return img;
+    return ret;
+}
+
+/*!
+ * \brief CoverArtLoader::decode() decodes \a picture at a size that fits \a bounds, see \ref FMUtil::fitSize()
+ */
+QImage CoverArtLoader::decode(const QByteArray &picture, const QSize &bounds)
+{
+    QBuffer buffer;
+    buffer.setData(picture);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+
+    QSize size = FMUtil::fitSize(reader.size(), bounds);
+    if (size.isValid()) {
+        // JPEG is decoded at the reduced size, other formats are scaled after being read
+        reader.setScaledSize(size);
+    }
+    return reader.read();
+}
+
+/*!
+ * \brief CoverArtLoader::trimCache() counts a new file and every \ref coverArtTrimInterval files trims the cache
+ *
+ *  Pictures and index files are written at different rates, both directories are trimmed at once.
+ */
+void CoverArtLoader::trimCache()
+{
+    if (coverArtFilesWritten.fetchAndAddOrdered(1) % coverArtTrimInterval != coverArtTrimInterval - 1) {
+        return;
+    }
+    removeOldFiles(m_cacheDir);
+    removeOldFiles(m_cacheDir + QLatin1String("/index"));
 }
 
+/*!
+ * \brief CoverArtLoader::removeOldFiles() keeps the \ref COVER_ART_CACHE_MAX_FILES most recent files of \a dir
+ */
+void CoverArtLoader::removeOldFiles(const QString &dir)
+{
+    QDir cacheDir(dir);
+    QFileInfoList files = cacheDir.entryInfoList(QDir::Files, QDir::Time);
+    for (int counter = COVER_ART_CACHE_MAX_FILES; counter < files.count(); ++counter) {
+        QFile::remove(files.at(counter).absoluteFilePath());
+    }
+}
 
+
+CoverArtAsyncImageProvider::CoverArtAsyncImageProvider(const QSize &defaultSize)
+    : QQuickAsyncImageProvider()
+    , m_defaultSize(defaultSize)
+    , m_cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                 + QLatin1String("/covers"))
+{
+}
+
+QQuickImageResponse *CoverArtAsyncImageProvider::requestImageResponse(const QString &id,
+                                                                      const QSize &requestedSize)
+{
+    QSize bounds = requestedSize;
+    if (bounds.width() <= 0 && bounds.height() <= 0) {
+        bounds = m_defaultSize;
+    }
+    return new ImageLoaderResponse(new CoverArtLoader(id, bounds, m_cacheDir), IOScheduler::CoverArtPool);
+}
+
+/*!
+ * \brief CoverArtAsyncImageProvider::setCacheDir() sets where scaled covers are saved, an empty \a dir disables it
+ */
+void CoverArtAsyncImageProvider::setCacheDir(const QString &dir)
+{
+    m_cacheDir = dir;
+}
+
+QString CoverArtAsyncImageProvider::cacheDir() const
+{
+    return m_cacheDir;
+}
+
+
+CoverArtImageProvider::CoverArtImageProvider()
+    : CoverArtAsyncImageProvider(QSize(COVER_ART_SIZE, COVER_ART_SIZE))
+{
+}
+
+
+CoverArtFullImageProvider::CoverArtFullImageProvider()
+    : CoverArtAsyncImageProvider(QSize(COVER_ART_FULL_SIZE, COVER_ART_FULL_SIZE))
+{
+}
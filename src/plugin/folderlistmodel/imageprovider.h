@@ -41,28 +41,104 @@
 #ifndef IMAGEPROVIDER_H
 #define IMAGEPROVIDER_H
 
+#include "imageloader.h"
+
 #include <QtGlobal>
 
 #include <QQuickImageProvider>
 #include <QImage>
+#include <QSize>
+
+class QFileInfo;
+
+/*!
+ *  Default sizes of the cover art providers when QML does not set a sourceSize
+ */
+#define COVER_ART_SIZE                 45
+#define COVER_ART_FULL_SIZE            300
+
+/*!
+ *  Maximum number of scaled covers kept in the disk cache, the oldest are removed
+ */
+#define COVER_ART_CACHE_MAX_FILES      2000
+
+/*!
+ *  Length of the hex SHA-1 of a picture, the cache name shared by the tracks that embed it
+ */
+#define COVER_ART_HASH_LENGTH          40
+
+/*!
+ *  Kept in the index instead of the hash when the track has no picture or it could not be decoded
+ */
+#define COVER_ART_FAILED               "fail"
 
 
-class CoverArtImageProvider : public QQuickImageProvider
+/*!
+ * \brief The CoverArtLoader class gets the embedded picture of an audio file scaled to a size
+ *
+ *  The picture is decoded straight at the scaled size, the result is saved in a disk cache
+ *  named after the hash of the picture bytes and the size, so tracks of an album share the file.
+ *  The hash of each track is kept in the index/ sub directory by path, size and modification time,
+ *  a cover already cached is then loaded without parsing the track.
+ *  Tracks without a picture or whose picture cannot be decoded get \ref COVER_ART_FAILED in the index,
+ *  like the "fail" directory of the freedesktop.org thumbnails, they are not parsed again until they change.
+ */
+class CoverArtLoader : public ImageLoader
 {
+    Q_OBJECT
 public:
-    explicit CoverArtImageProvider();
+    CoverArtLoader(const QString &path, const QSize &bounds, const QString &cacheDir);
+    void run();
+
+    static QByteArray readPicture(const QString &path);
+    static QImage     decode(const QByteArray &picture, const QSize &bounds);
 
-    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+private:
+    QString           coverFileName(const QByteArray &hash) const;
+    QString           indexFileName(const QFileInfo &info) const;
+    void              saveFile(const QString &fileName, const QByteArray &contents);
+    void              trimCache();
+    static void       removeOldFiles(const QString &dir);
 
+private:
+    QString  m_path;
+    QSize    m_bounds;
+    QString  m_cacheDir;
 };
 
-class CoverArtFullImageProvider : public QQuickImageProvider
+
+/*!
+ * \brief The CoverArtAsyncImageProvider class provides cover art without blocking the QML image loader
+ *
+ *  The id is the audio file path, pictures are loaded by the \ref IOScheduler::CoverArtPool.
+ *  The requested size is honoured, when it is not set the provider default size is used.
+ */
+class CoverArtAsyncImageProvider : public QQuickAsyncImageProvider
 {
 public:
-    explicit CoverArtFullImageProvider();
+    explicit CoverArtAsyncImageProvider(const QSize &defaultSize);
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize);
 
-    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+    void     setCacheDir(const QString &dir);
+    QString  cacheDir() const;
 
+private:
+    QSize    m_defaultSize;
+    QString  m_cacheDir;
+};
+
+
+class CoverArtImageProvider : public CoverArtAsyncImageProvider
+{
+public:
+    explicit CoverArtImageProvider();
+};
+
+class CoverArtFullImageProvider : public CoverArtAsyncImageProvider
+{
+public:
+    explicit CoverArtFullImageProvider();
 };
 
 
@@ -33,6 +33,8 @@
 #include "qtrashutilinfo.h"
 #include "diriteminfo.h"
 #include "trashiteminfo.h"
+#include "diskdirscanner.h"
+#include "diskparallelscanner.h"
 
 #include <QDirIterator>
 #include <QDebug>
@@ -42,7 +44,7 @@
 #include <QThread>
 #endif
 
-IORequest::IORequest() : QObject(), m_type(DirList)
+IORequest::IORequest() : QObject(), m_type(DirList), m_priority(RefreshPriority)
 {
 }
 
@@ -56,6 +58,31 @@ IORequest::RequestType IORequest::type() const
     return m_type;
 }
 
+IORequest::Priority IORequest::priority() const
+{
+    return m_priority;
+}
+
+void IORequest::setPriority(Priority priority)
+{
+    m_priority = priority;
+}
+
+/*!
+ * \brief IORequest::setCancelToken() replaces the request token by \a token
+ *
+ *  It allows several requests to be cancelled at once, see \ref TrashLocation::fetchItems()
+ */
+void IORequest::setCancelToken(const IORequestCancelToken &token)
+{
+    m_cancelToken = token;
+}
+
+IORequestCancelToken IORequest::cancelToken() const
+{
+    return m_cancelToken;
+}
+
 //----------------------------------------------------------------------------------
 IORequestLoader::IORequestLoader(const QString &pathName,
                                  QDir::Filters filter,
@@ -65,6 +92,11 @@ IORequestLoader::IORequestLoader(const QString &pathName,
     , mPathName(pathName)
     , mFilter(filter)
     , mIsRecursive(isRecursive)
+    , mStreaming(false)
+    , mBatchesEmitted(0)
+    , mNativeScanner(false)
+    , mLazyStat(false)
+    , mSortFunction(0)
 {
 }
 
@@ -78,6 +110,11 @@ IORequestLoader::IORequestLoader(const QString &trashRootDir,
     , mFilter(filter)
     , mIsRecursive(isRecursive)
     , mTtrashRootDir(trashRootDir)
+    , mStreaming(false)
+    , mBatchesEmitted(0)
+    , mNativeScanner(false)
+    , mLazyStat(false)
+    , mSortFunction(0)
 {
 
 }
@@ -87,9 +124,97 @@ IORequestLoader::~IORequestLoader()
 
 }
 
+/*!
+ * \brief IORequestLoader::setStreaming() when \a stream is true the content is sent in batches
+ *
+ *  Partial results are emitted by \ref itemsAdded() while the scan continues,
+ *  \ref getContents() returns only the items that were not emitted yet.
+ */
+void IORequestLoader::setStreaming(bool stream)
+{
+    mStreaming = stream;
+}
+
+bool IORequestLoader::isStreaming() const
+{
+    return mStreaming;
+}
+
+/*!
+ * \brief IORequestLoader::setNativeScanner() when \a useNative is true local directories are read by \ref DiskDirScanner
+ *
+ *  It is ignored when \ref DiskDirScanner::isAvailable() returns false.
+ */
+void IORequestLoader::setNativeScanner(bool useNative)
+{
+    mNativeScanner = useNative && DiskDirScanner::isAvailable();
+}
+
+/*!
+ * \brief IORequestLoader::setLazyStat() when \a lazy is true files and directories are listed without stat()
+ *
+ *  Only names and types are read, see \ref DirItemInfo::setLocalFileFromDirEntry(),
+ *  it applies to non recursive listings done by \ref DiskDirScanner.
+ */
+void IORequestLoader::setLazyStat(bool lazy)
+{
+    mLazyStat = lazy;
+}
+
+/*!
+ * \brief IORequestLoader::setSortFunction() sorts each emitted batch using \a compare
+ *
+ *  Sorting in the IO thread lets \ref DirModel::onItemsAdded() just merge the batch.
+ */
+void IORequestLoader::setSortFunction(CompareFunction compare)
+{
+    mSortFunction = compare;
+}
+
+/*!
+ * \brief IORequestLoader::flushBatchIfNeeded() emits \a batch when it is big enough or old enough
+ *
+ *  The \a batch is cleared after being emitted.
+ */
+void IORequestLoader::flushBatchIfNeeded(DirItemInfoList &batch)
+{
+    if (!mStreaming || batch.isEmpty() || isCancelled()) {
+        return;
+    }
+
+    int limit = mBatchesEmitted == 0 ? DIRLIST_FIRST_BATCH_SIZE : DIRLIST_BATCH_SIZE;
+    if (batch.count() >= limit || mBatchTimer.elapsed() >= DIRLIST_BATCH_INTERVAL) {
+        DirItemInfoList ready;
+        ready.swap(batch);
+        batch.reserve(DIRLIST_BATCH_SIZE);
+        prepareBatch(ready);
+        ++mBatchesEmitted;
+        emit itemsAdded(ready);
+        mBatchTimer.restart();
+    }
+}
+
+/*!
+ * \brief IORequestLoader::prepareBatch() does the work the GUI thread would do on \a batch
+ *
+ *  Items get their mime type from the name, nothing is written into them once they are shared
+ *  with the GUI thread. They are sorted when \ref setSortFunction() was called
+ */
+void IORequestLoader::prepareBatch(DirItemInfoList &batch)
+{
+    for (int counter = 0; counter < batch.count(); ++counter) {
+        batch[counter].resolveMimeTypeFromName();
+    }
+    if (mSortFunction) {
+        sortItems(batch, mSortFunction);
+    }
+}
+
 DirItemInfoList  IORequestLoader::getContents()
 {
     DirItemInfoList list;
+    mBatchesEmitted = 0;
+    mBatchTimer.start();
     switch (mLoaderType) {
     case  NormalLoader:
         list = getNormalContent();
@@ -111,27 +236,70 @@ DirItemInfoList  IORequestLoader::getNormalContent()
              << Q_FUNC_INFO;
 #endif
     DirItemInfoList directoryContents;
-    directoryContents = add(mPathName, mFilter, mIsRecursive, directoryContents);
+    if (mIsRecursive) {
+        addRecursive(mPathName, mFilter, directoryContents);
+    } else {
+        add(mPathName, mFilter, directoryContents);
+    }
     return directoryContents;
 }
 
-DirItemInfoList IORequestLoader::add(const QString &pathName,
-                                     QDir::Filters filter,
-                                     bool isRecursive,
-                                     DirItemInfoList directoryContents)
+void IORequestLoader::add(const QString &pathName,
+                          QDir::Filters filter,
+                          DirItemInfoList &directoryContents)
 {
+    if (mNativeScanner) {
+        addFromScanner(pathName, filter, directoryContents);
+        return;
+    }
     QDir tmpDir = QDir(pathName, QString(), QDir::NoSort, filter);
     QDirIterator it(tmpDir);
-    while (it.hasNext()) {
+    while (it.hasNext() && !isCancelled()) {
         it.next();
-        if (it.fileInfo().isDir() && isRecursive) {
-            directoryContents = add(it.fileInfo().filePath(),
-                                    filter, isRecursive, directoryContents);
-        } else {
-            directoryContents.append(DirItemInfo(it.fileInfo()));
+        directoryContents.append(DirItemInfo(it.fileInfo()));
+        flushBatchIfNeeded(directoryContents);
+    }
+}
+
+/*!
+ * \brief IORequestLoader::addFromScanner() same as \ref add() but using \ref DiskDirScanner
+ */
+void IORequestLoader::addFromScanner(const QString &pathName,
+                                     QDir::Filters filter,
+                                     DirItemInfoList &directoryContents)
+{
+    DiskDirScanner scanner(filter);
+    scanner.setLazyStat(mLazyStat);
+    if (scanner.open(pathName)) {
+        DirItemInfo item;
+        while (!isCancelled() && scanner.next(item)) {
+            directoryContents.append(item);
+            flushBatchIfNeeded(directoryContents);
         }
     }
-    return directoryContents;
+}
+
+/*!
+ * \brief IORequestLoader::addRecursive() gets the files of \a pathName and of all its sub directories
+ *
+ *  Directories are read in parallel by \ref DiskParallelScanner, this thread only merges
+ *  the chunks it produces into \a directoryContents and sends the streaming batches.
+ */
+void IORequestLoader::addRecursive(const QString &pathName,
+                                   QDir::Filters filter,
+                                   DirItemInfoList &directoryContents)
+{
+    DiskParallelScanner scanner(filter, mNativeScanner);
+    scanner.start(pathName);
+    DirItemInfoList chunk;
+    while (scanner.takeResults(chunk)) {
+        if (isCancelled()) {
+            scanner.stop();
+            break;
+        }
+        directoryContents += chunk;
+        flushBatchIfNeeded(directoryContents);
+    }
 }
 
 DirItemInfoList  IORequestLoader::getTrashContent()
@@ -141,7 +309,7 @@ DirItemInfoList  IORequestLoader::getTrashContent()
     QDir tmpDir = QDir(mPathName, QString(), QDir::NoSort, mFilter);
     bool isTopLevel = QFileInfo(mPathName).absolutePath() == mTtrashRootDir;
     QDirIterator it(tmpDir);
-    while (it.hasNext()) {
+    while (it.hasNext() && !isCancelled()) {
         it.next();
         trashInfo.setInfo(mTtrashRootDir, it.fileInfo().absoluteFilePath());
         if (!isTopLevel || (isTopLevel && trashInfo.existsInfoFile() && trashInfo.existsFile()) ) {
@@ -151,6 +319,7 @@ DirItemInfoList  IORequestLoader::getTrashContent()
             TrashItemInfo item(QTrashUtilInfo::filesTrashDir(mTtrashRootDir),
                                it.fileInfo().absoluteFilePath());
             directoryContents.append(item);
+            flushBatchIfNeeded(directoryContents);
         }
     }
     return directoryContents;
@@ -169,7 +338,8 @@ DirItemInfoList IORequestLoader::getNetworkContent()
 DirListWorker::DirListWorker(const QString &pathName, QDir::Filters filter, const bool isRecursive)
     : IORequestLoader(pathName, filter, isRecursive)
 {
-
+    mStreaming = true;
+    m_priority = NavigationPriority;
 }
 
 
@@ -177,7 +347,8 @@ DirListWorker::DirListWorker(const QString &trashRootDir, const QString &pathNam
                              QDir::Filters filter, const bool isRecursive)
     : IORequestLoader(trashRootDir, pathName, filter, isRecursive)
 {
-
+    mStreaming = true;
+    m_priority = NavigationPriority;
 }
 
 DirListWorker::~DirListWorker()
@@ -191,11 +362,16 @@ void DirListWorker::run()
     qDebug() << Q_FUNC_INFO << "Running on: " << QThread::currentThreadId();
 #endif
 
+    // when streaming previous batches were already emitted from getContents()
     DirItemInfoList directoryContents = getContents();
 
-    // last batch
-    emit itemsAdded(directoryContents);
-    emit workerFinished();
+    // a cancelled request was replaced by another one, nobody wants its results
+    if (!isCancelled()) {
+        // last batch
+        prepareBatch(directoryContents);
+        emit itemsAdded(directoryContents);
+        emit workerFinished();
+    }
 }
 
 
@@ -223,6 +399,7 @@ ExternalFileSystemChangesWorker::ExternalFileSystemChangesWorker(const DirItemIn
 
 {
     m_type        = DirListExternalFSChanges;
+    m_priority    = ExternalChangesPriority;
     int counter = content.count();
     while (counter--) {
         m_curContent.insert( content.at(counter).absoluteFilePath(), content.at(counter) );
@@ -235,10 +412,16 @@ ExternalFileSystemChangesWorker::~ExternalFileSystemChangesWorker()
 
 }
 
+/*!
+ * \brief ExternalFileSystemChangesWorker::compareItems() compares \a contentNew with the current listing
+ *
+ *  All differences are emitted at once by \ref changesFound(), so the GUI thread handles a single event.
+ *
+ * \return the number of items in \a contentNew
+ */
 int ExternalFileSystemChangesWorker::compareItems(const DirItemInfoList &contentNew)
 {
-    int   addedCounter = 0;
-    int   removedCounter = 0;
+    DirItemChangeSet changes;
 #if DEBUG_EXT_FS_WATCHER
     qDebug() << "[exfsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
              << Q_FUNC_INFO
@@ -247,41 +430,65 @@ int ExternalFileSystemChangesWorker::compareItems(const DirItemInfoList &content
 #endif
     int counter = contentNew.count();
     if (counter > 0) {
-        int tmpCounter = counter;
-        while (tmpCounter--) {
+        for (int tmpCounter = 0; tmpCounter < counter; ++tmpCounter) {
             const DirItemInfo &originalItem = contentNew.at(tmpCounter);
-            const DirItemInfo  existItem    = m_curContent.value(originalItem.absoluteFilePath());
-            if ( existItem.exists() ) {
-                //it may have changed
-                if (   originalItem.size()         != existItem.size()
-                        || originalItem.lastModified() != existItem.lastModified()
-                        || originalItem.permissions()  != existItem.permissions()
-                   ) {
-                    emit changed(originalItem);
+            QHash<QString, DirItemInfo>::iterator existItem = m_curContent.find(originalItem.absoluteFilePath());
+            if (existItem != m_curContent.end()) {
+                if (hasChanged(existItem.value(), originalItem)) {
+                    changes.changed.append(originalItem);
                 }
                 //remove this item
-                m_curContent.remove(originalItem.absoluteFilePath());
+                m_curContent.erase(existItem);
             } else { // originalItem was added
-                emit added(originalItem);
-                ++addedCounter;
+                changes.added.append(originalItem);
             }
         }
 
+        changes.removed.reserve(m_curContent.count());
         QHash<QString, DirItemInfo>::iterator  i = m_curContent.begin();
-        for ( ;  i != m_curContent.end();  ++removedCounter, ++i ) {
-            emit removed(i.value());
+        for ( ;  i != m_curContent.end();  ++i ) {
+            changes.removed.append(i.value());
         }
     }
 #if DEBUG_EXT_FS_WATCHER
     qDebug() << "[exfsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
              << Q_FUNC_INFO
-             << "addedCounter:"   << addedCounter
-             << "removedCounter:" << removedCounter;
+             << "addedCounter:"   << changes.added.count()
+             << "removedCounter:" << changes.removed.count()
+             << "changedCounter:" << changes.changed.count();
 #endif
 
+    emitChanges(changes);
     return counter;
 }
 
+/*!
+ * \brief ExternalFileSystemChangesWorker::emitChanges() emits \a changes unless it is empty or cancelled
+ *
+ *  Added and changed items are prepared as \ref prepareBatch() does, removed ones are the GUI thread copies.
+ */
+void ExternalFileSystemChangesWorker::emitChanges(DirItemChangeSet &changes)
+{
+    if (!changes.isEmpty() && !isCancelled()) {
+        prepareBatch(changes.changed);
+        prepareBatch(changes.added);
+        emit changesFound(changes);
+    }
+}
+
+/*!
+ * \brief ExternalFileSystemChangesWorker::hasChanged() true when \a found differs from the \a current item
+ *
+ *  An item not stat'ed yet will get the current values anyway, it is not considered changed.
+ */
+bool ExternalFileSystemChangesWorker::hasChanged(const DirItemInfo &current, const DirItemInfo &found)
+{
+    return !current.needsStat() && (
+               found.size()                != current.size()
+               || found.lastModifiedMSecs() != current.lastModifiedMSecs()
+               || found.permissions()       != current.permissions());
+}
+
 void ExternalFileSystemChangesWorker::run()
 {
     DirItemInfoList directoryContents = getContents();
@@ -290,6 +497,64 @@ void ExternalFileSystemChangesWorker::run()
 }
 
 
+//---------------------------------------------------------------------
+ExternalFileSystemEntriesWorker::ExternalFileSystemEntriesWorker(const DirItemInfoList &content,
+                                                                 const QString &pathName,
+                                                                 const QStringList &names,
+                                                                 QDir::Filters filter)
+    : ExternalFileSystemChangesWorker(content, pathName, filter, false)
+    , m_names(names)
+{
+}
+
+ExternalFileSystemEntriesWorker::~ExternalFileSystemEntriesWorker()
+{
+
+}
+
+void ExternalFileSystemEntriesWorker::run()
+{
+    const QDir dir(mPathName);
+    DirItemChangeSet changes;
+    foreach (const QString &name, m_names) {
+        if (isCancelled()) {
+            return;
+        }
+        const QString absPath = dir.absoluteFilePath(name);
+        const DirItemInfo current = m_curContent.value(absPath);
+        DirItemInfo found((QFileInfo(absPath)));
+
+        bool accepted = found.exists();
+        if (accepted && !(mFilter & QDir::Hidden) && name.startsWith(QLatin1Char('.'))) {
+            accepted = false;
+        }
+        if (accepted) {
+            accepted = found.isDir() ? mFilter.testFlag(QDir::Dirs) || mFilter.testFlag(QDir::AllDirs)
+                                     : mFilter.testFlag(QDir::Files);
+        }
+
+        if (!accepted) {
+            if (current.exists()) {
+                changes.removed.append(current);
+            }
+        } else if (!current.exists()) {
+            changes.added.append(found);
+        } else if (hasChanged(current, found)) {
+            changes.changed.append(found);
+        }
+    }
+#if DEBUG_EXT_FS_WATCHER
+    qDebug() << "[exfsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
+             << Q_FUNC_INFO
+             << "names:"          << m_names.count()
+             << "addedCounter:"   << changes.added.count()
+             << "removedCounter:" << changes.removed.count()
+             << "changedCounter:" << changes.changed.count();
+#endif
+    emitChanges(changes);
+}
+
+
 //---------------------------------------------------------------------
 ExternalFileSystemTrashChangesWorker::ExternalFileSystemTrashChangesWorker(
     const QStringList &pathNames,
@@ -33,9 +33,40 @@
 #define IOREQUEST_H
 
 #include "diriteminfo.h"
+#include "filecompare.h"
 
 #include <QHash>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QSharedPointer>
+
+/*!
+ * Streaming limits used by \ref IORequestLoader when it sends partial results:
+ *  a batch is emitted when it reaches the item limit or when the time limit has elapsed,
+ *  the first batch is smaller so the first rows can be shown as soon as possible
+ */
+#define DIRLIST_FIRST_BATCH_SIZE       64
+#define DIRLIST_BATCH_SIZE             1024
+#define DIRLIST_BATCH_INTERVAL         100   // ms
+
+/*!
+ * \brief The IORequestCancelToken class is a cancellation flag shared by copies
+ *
+ *  The creator of an \ref IORequest keeps a copy of the token given to the request,
+ *  cancelling the copy makes the request stop its loops and discard its results.
+ *  It is also used to drop results that were already queued to the GUI thread.
+ */
+class IORequestCancelToken
+{
+public:
+    IORequestCancelToken() : m_cancelled(new QAtomicInt(0)) {}
+    inline void cancel()            { m_cancelled->store(1); }
+    inline bool isCancelled() const { return m_cancelled->load() != 0; }
+private:
+    QSharedPointer<QAtomicInt> m_cancelled;
+};
+
 
 class IORequest : public QObject
 {
@@ -48,10 +79,34 @@ public:
     enum RequestType {
         DirList,
         DirListExternalFSChanges,
-        SambaList
+        SambaList,
+        ListingSnapshotSave,
+        ChildCount,
+        ItemStat,
+        MimeTypeResolve,
+        AudioMetaDataRead,
+        CoverArtLoad,
+        ThumbnailLoad
     };
+
+    /*!
+     * \brief The Priority enum defines the order requests are run by \ref IORequestWorker,
+     *  higher values run first, requests with the same priority run in FIFO order
+     */
+    enum Priority {
+        PrefetchPriority = 0,     //!< work the user has not asked for yet
+        ExternalChangesPriority,  //!< diff after the External File System Watcher notified a change
+        RefreshPriority,          //!< reload of the path being shown
+        NavigationPriority        //!< user is going to another path
+    };
+
     virtual void run() = 0;
     RequestType  type() const;
+    Priority     priority() const;
+    void         setPriority(Priority priority);
+    void         setCancelToken(const IORequestCancelToken &token);
+    IORequestCancelToken cancelToken() const;
+    inline bool  isCancelled() const { return m_cancelToken.isCancelled(); }
 
 private:
     // hide this because IORequest should *NOT* be parented directly
@@ -59,6 +114,8 @@ private:
 
 protected:
     RequestType  m_type;
+    Priority     m_priority;
+    IORequestCancelToken m_cancelToken;
 };
 
 
@@ -84,6 +141,11 @@ public:
                    );
     virtual ~IORequestLoader();
     DirItemInfoList     getContents();
+    void                setStreaming(bool stream);
+    bool                isStreaming() const;
+    void                setNativeScanner(bool useNative);
+    void                setLazyStat(bool lazy);
+    void                setSortFunction(CompareFunction compare);
 
 signals:
     void itemsAdded(const DirItemInfoList &files);
@@ -92,14 +154,28 @@ private:
     DirItemInfoList getNormalContent();
     DirItemInfoList getTrashContent();
     virtual DirItemInfoList getNetworkContent();
-    DirItemInfoList add(const QString &pathName, QDir::Filters filter,
-                        bool isRecursive, DirItemInfoList directoryContents);
+    void            add(const QString &pathName, QDir::Filters filter,
+                        DirItemInfoList &directoryContents);
+    void            addFromScanner(const QString &pathName, QDir::Filters filter,
+                                   DirItemInfoList &directoryContents);
+    void            addRecursive(const QString &pathName, QDir::Filters filter,
+                                 DirItemInfoList &directoryContents);
+protected:
+    void          flushBatchIfNeeded(DirItemInfoList &batch);
+    void          prepareBatch(DirItemInfoList &batch);
+
 protected:
     LoaderType    mLoaderType;
     QString       mPathName;
     QDir::Filters mFilter;
     bool          mIsRecursive;
     QString       mTtrashRootDir;
+    bool          mStreaming;       //!< when true partial results are emitted by \ref flushBatchIfNeeded()
+    int           mBatchesEmitted;
+    QElapsedTimer mBatchTimer;
+    bool          mNativeScanner;   //!< when true \ref DiskDirScanner is used instead of QDirIterator
+    bool          mLazyStat;        //!< see \ref setLazyStat()
+    CompareFunction mSortFunction;  //!< when set batches are sorted before being emitted
 };
 
 
@@ -133,6 +209,23 @@ public:
 
 
 
+/*!
+ * \brief The DirItemChangeSet struct holds the differences found by \ref ExternalFileSystemChangesWorker
+ *
+ *  \a added is sorted when the worker has a sort function, see \ref IORequestLoader::setSortFunction()
+ */
+struct DirItemChangeSet {
+    DirItemInfoList added;
+    DirItemInfoList removed;
+    DirItemInfoList changed;
+
+    bool isEmpty() const { return added.isEmpty() && removed.isEmpty() && changed.isEmpty(); }
+};
+
+Q_DECLARE_METATYPE(DirItemChangeSet)
+
+
+
 class  ExternalFileSystemChangesWorker : public IORequestLoader
 {
     Q_OBJECT
@@ -146,19 +239,41 @@ public:
 
 protected:
     int  compareItems(const DirItemInfoList &contentNew);
+    void emitChanges(DirItemChangeSet &changes);
+    static bool hasChanged(const DirItemInfo &current, const DirItemInfo &found);
 
 signals:
-    void     removed(const DirItemInfo &);
-    void     changed(const DirItemInfo &);
-    void     added(const   DirItemInfo & );
+    void     changesFound(const DirItemChangeSet &changes);
     void     finished(int);
-private:
+protected:
     QHash<QString, DirItemInfo>
     m_curContent;   //!< using hash because the vector can be in any order
 };
 
 
 
+/*!
+ * \brief The ExternalFileSystemEntriesWorker class checks only the entries an inotify watcher reported
+ *
+ *  Each name is stat'ed and compared with the current item, so the cost does not depend on
+ *  the size of the directory. \ref finished() is not emitted, the directory was not read.
+ */
+class ExternalFileSystemEntriesWorker : public ExternalFileSystemChangesWorker
+{
+    Q_OBJECT
+public:
+    ExternalFileSystemEntriesWorker(const DirItemInfoList &content,
+                                    const QString &pathName,
+                                    const QStringList &names,
+                                    QDir::Filters filter);
+    virtual ~ExternalFileSystemEntriesWorker();
+    void run();
+private:
+    QStringList    m_names;
+};
+
+
+
 class ExternalFileSystemTrashChangesWorker : public ExternalFileSystemChangesWorker
 {
     Q_OBJECT
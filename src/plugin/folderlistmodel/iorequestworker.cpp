@@ -36,65 +36,131 @@
 #include <QDateTime>
 #include <QDebug>
 
-/*!
-  Lives on an IOWorkerThread.
-
-  Responsible for running IORequest jobs on the thread instance, and
-  disposing of their resources once they are done.
- */
-IORequestWorker::IORequestWorker()
-    : QThread()
-    , mTimeToQuit(false)
+IORequestQueue::IORequestQueue()
+    : mTimeToQuit(false)
+    , mLastInFirstOut(false)
+    , mMaxDepth(0)
+    , mRunning(0)
+    , mProcessed(0)
 {
 }
 
-void IORequestWorker::addRequest(IORequest *request)
+void IORequestQueue::enqueue(IORequest *request)
 {
 #if DEBUG_EXT_FS_WATCHER
     qDebug() << "[exfsWatcher]" << QDateTime::currentDateTime().toString("hh:mm:ss.zzz")
              << Q_FUNC_INFO;
 #endif
 
-    request->moveToThread(this);
-
-    // TODO: queue requests so we run the most important one first
     QMutexLocker lock(&mMutex);
-    mRequests.append(request);
+    // keep the queue sorted by priority, FIFO (or LIFO) for requests with the same priority
+    int pos = mRequests.count();
+    while (pos > 0 && (mRequests.at(pos - 1)->priority() < request->priority()
+                       || (mLastInFirstOut && mRequests.at(pos - 1)->priority() == request->priority()))) {
+        --pos;
+    }
+    mRequests.insert(pos, request);
+    if (mRequests.count() > mMaxDepth) {
+        mMaxDepth = mRequests.count();
+    }
 
-    // wake run()
+    // wake one of the IORequestWorker::run()
     mWaitCondition.wakeOne();
 }
 
-void IORequestWorker::run()
+/*!
+  Blocks until there is a request to run, returns 0 when it is time to quit.
+ */
+IORequest *IORequestQueue::dequeue()
 {
-    forever {
-        QMutexLocker lock(&mMutex);
-
-        if (mTimeToQuit)
-            return;
-
-        if (mRequests.empty())
-            mWaitCondition.wait(&mMutex);
-
-        while (!mRequests.isEmpty()) {
-            IORequest *request = mRequests.takeFirst();
-
-            lock.unlock();
-
-            request->run();
-            request->deleteLater();
-            lock.relock();
-        }
+    QMutexLocker lock(&mMutex);
+    while (!mTimeToQuit && mRequests.isEmpty()) {
+        mWaitCondition.wait(&mMutex);
+    }
+    if (mTimeToQuit) {
+        return 0;
     }
+    ++mRunning;
+    return mRequests.takeFirst();
 }
 
+void IORequestQueue::requestDone()
+{
+    QMutexLocker lock(&mMutex);
+    --mRunning;
+    ++mProcessed;
+}
 
-void IORequestWorker::exit()
+void IORequestQueue::quit()
 {
 #if DEBUG_MESSAGES
     qDebug() << Q_FUNC_INFO << "Quitting";
 #endif
     QMutexLocker lock(&mMutex);
     mTimeToQuit = true;
-    mWaitCondition.wakeOne();
+    mWaitCondition.wakeAll();
+}
+
+/*!
+  When \a lifo is true the last request enqueued runs first among requests with the same priority,
+  it suits requests for what is on the screen now, such as images of the rows being shown.
+ */
+void IORequestQueue::setLastInFirstOut(bool lifo)
+{
+    QMutexLocker lock(&mMutex);
+    mLastInFirstOut = lifo;
+}
+
+/*!
+  Number of requests waiting to run.
+ */
+int IORequestQueue::depth() const
+{
+    QMutexLocker lock(&mMutex);
+    return mRequests.count();
+}
+
+int IORequestQueue::maxDepth() const
+{
+    QMutexLocker lock(&mMutex);
+    return mMaxDepth;
+}
+
+int IORequestQueue::running() const
+{
+    QMutexLocker lock(&mMutex);
+    return mRunning;
+}
+
+qint64 IORequestQueue::processed() const
+{
+    QMutexLocker lock(&mMutex);
+    return mProcessed;
+}
+
+/*!
+  Lives on an IOWorkerThread.
+
+  Responsible for running IORequest jobs taken from the IORequestQueue shared by the
+  threads of the same IOWorkerThread, and disposing of their resources once they are done.
+
+  Requests are run by IORequest::priority(), cancelled requests are disposed without running.
+  Requests keep the affinity of the thread that created them, deleteLater() disposes them there.
+ */
+IORequestWorker::IORequestWorker(IORequestQueue *queue)
+    : QThread()
+    , mQueue(queue)
+{
+}
+
+void IORequestWorker::run()
+{
+    IORequest *request = 0;
+    while ((request = mQueue->dequeue()) != 0) {
+        if (!request->isCancelled()) {
+            request->run();
+        }
+        request->deleteLater();
+        mQueue->requestDone();
+    }
 }
@@ -39,23 +39,47 @@
 
 #include "iorequest.h"
 
-class IORequestWorker : public QThread
+/*!
+ * \brief The IORequestQueue class is a priority queue of \ref IORequest shared by the threads of a pool
+ */
+class IORequestQueue
 {
-    Q_OBJECT
 public:
-    explicit IORequestWorker();
-
-    void addRequest(IORequest *request);
+    IORequestQueue();
 
-    void run();
+    void        enqueue(IORequest *request);
+    IORequest  *dequeue();
+    void        requestDone();
+    void        quit();
+    void        setLastInFirstOut(bool lifo);
 
-    void exit();
+    int         depth() const;
+    int         maxDepth() const;
+    int         running() const;
+    qint64      processed() const;
 
 private:
-    QMutex mMutex;
+    mutable QMutex mMutex;
     QWaitCondition mWaitCondition;
     QList<IORequest *> mRequests;
     bool mTimeToQuit;
+    bool mLastInFirstOut;   //!< requests with the same priority run newest first
+    int  mMaxDepth;
+    int  mRunning;
+    qint64 mProcessed;
+};
+
+
+class IORequestWorker : public QThread
+{
+    Q_OBJECT
+public:
+    explicit IORequestWorker(IORequestQueue *queue);
+
+    void run();
+
+private:
+    IORequestQueue *mQueue;
 };
 
 #endif // IOREQUESTWORKER_H
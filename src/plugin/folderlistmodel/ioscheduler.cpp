@@ -0,0 +1,135 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: ioscheduler.cpp
+ * Date: 17/10/2026
+ */
+
+#include "ioscheduler.h"
+#include "ioworkerthread.h"
+
+#include <QMutexLocker>
+
+Q_GLOBAL_STATIC(IOScheduler, ioScheduler)
+
+const QString IOScheduler::LocalDiskPool(QLatin1String("disk"));
+const QString IOScheduler::TrashPool(QLatin1String("trash"));
+const QString IOScheduler::CoverArtPool(QLatin1String("cover-art"));
+const QString IOScheduler::ThumbnailPool(QLatin1String("thumbnail"));
+
+
+IOScheduler::IOScheduler(QObject *parent) : QObject(parent)
+{
+}
+
+IOScheduler::~IOScheduler()
+{
+    qDeleteAll(m_pools);
+}
+
+IOScheduler *IOScheduler::instance()
+{
+    return ioScheduler();
+}
+
+/*!
+ * \brief IOScheduler::networkPoolName() pool name for a remote host, e.g. "smb://server"
+ */
+QString IOScheduler::networkPoolName(const QString &scheme, const QString &host)
+{
+    return scheme + QLatin1String("://") + host.toLower();
+}
+
+/*!
+ * \brief IOScheduler::pool() returns the pool \a name, it is created when it does not exist yet
+ */
+IOWorkerThread *IOScheduler::pool(const QString &name)
+{
+    QMutexLocker lock(&m_mutex);
+    IOWorkerThread *ret = m_pools.value(name, 0);
+    if (ret == 0) {
+        ret = new IOWorkerThread(m_concurrency.value(name, defaultConcurrency(name)));
+        // images are asked for the rows being shown, the latest asked are the ones still visible
+        if (name == CoverArtPool || name == ThumbnailPool) {
+            ret->setLastInFirstOut(true);
+        }
+        m_pools.insert(name, ret);
+    }
+    return ret;
+}
+
+/*!
+ * \brief IOScheduler::setPoolConcurrency() sets the number of threads of the pool \a name
+ *
+ *  It can be called before the pool exists, running pools can only grow.
+ */
+void IOScheduler::setPoolConcurrency(const QString &name, int threads)
+{
+    if (threads < 1) {
+        threads = 1;
+    }
+    QMutexLocker lock(&m_mutex);
+    m_concurrency.insert(name, threads);
+    IOWorkerThread *existent = m_pools.value(name, 0);
+    if (existent) {
+        existent->setMaxThreads(threads);
+    }
+}
+
+int IOScheduler::poolConcurrency(const QString &name) const
+{
+    QMutexLocker lock(&m_mutex);
+    IOWorkerThread *existent = m_pools.value(name, 0);
+    return existent ? existent->maxThreads() : m_concurrency.value(name, defaultConcurrency(name));
+}
+
+int IOScheduler::defaultConcurrency(const QString &name) const
+{
+    if (name == LocalDiskPool) {
+        return IO_POOL_LOCAL_DISK_THREADS;
+    }
+    if (name == TrashPool) {
+        return IO_POOL_TRASH_THREADS;
+    }
+    if (name == CoverArtPool) {
+        return IO_POOL_COVER_ART_THREADS;
+    }
+    if (name == ThumbnailPool) {
+        return IO_POOL_THUMBNAIL_THREADS;
+    }
+    return IO_POOL_NETWORK_THREADS;
+}
+
+/*!
+ * \brief IOScheduler::statistics() returns the queue depth and counters of every pool
+ */
+QList<IOPoolStatistics> IOScheduler::statistics() const
+{
+    QList<IOPoolStatistics> ret;
+    QMutexLocker lock(&m_mutex);
+    QHash<QString, IOWorkerThread *>::const_iterator it = m_pools.constBegin();
+    for (; it != m_pools.constEnd(); ++it) {
+        IOPoolStatistics stats;
+        stats.name          = it.key();
+        stats.threads       = it.value()->maxThreads();
+        stats.queueDepth    = it.value()->queueDepth();
+        stats.maxQueueDepth = it.value()->maxQueueDepth();
+        stats.running       = it.value()->runningRequests();
+        stats.processed     = it.value()->processedRequests();
+        ret.append(stats);
+    }
+    return ret;
+}
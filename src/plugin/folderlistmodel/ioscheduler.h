@@ -0,0 +1,92 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: ioscheduler.h
+ * Date: 17/10/2026
+ */
+
+#ifndef IOSCHEDULER_H
+#define IOSCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QMutex>
+#include <QList>
+
+class IOWorkerThread;
+
+/*!
+ *  Default number of threads for each pool class
+ */
+#define IO_POOL_LOCAL_DISK_THREADS   2
+#define IO_POOL_TRASH_THREADS        1
+#define IO_POOL_NETWORK_THREADS      2   // per remote host
+#define IO_POOL_COVER_ART_THREADS    2
+#define IO_POOL_THUMBNAIL_THREADS    2
+
+/*!
+ * \brief The IOPoolStatistics struct is a snapshot of an \ref IOWorkerThread pool state
+ */
+struct IOPoolStatistics
+{
+    QString name;
+    int     threads;
+    int     queueDepth;     //!< requests waiting for a free thread
+    int     maxQueueDepth;  //!< highest queueDepth since the pool was created
+    int     running;
+    qint64  processed;
+};
+
+/*!
+ * \brief The IOScheduler class keeps separate \ref IOWorkerThread pools for each kind of \ref Location
+ *
+ *  Local disk, trash and every remote host have their own bounded pool, so a slow or hung
+ *  network request can never hold the threads used to browse local folders.
+ *
+ *  Pools are created on demand by \ref pool() and live until the application quits.
+ */
+class IOScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit IOScheduler(QObject *parent = 0);
+    ~IOScheduler();
+
+    static IOScheduler *instance();
+
+    IOWorkerThread *pool(const QString &name);
+    void            setPoolConcurrency(const QString &name, int threads);
+    int             poolConcurrency(const QString &name) const;
+    QList<IOPoolStatistics> statistics() const;
+
+    static QString  networkPoolName(const QString &scheme, const QString &host);
+
+public:
+    static const QString LocalDiskPool;
+    static const QString TrashPool;
+    static const QString CoverArtPool;   //!< decoding of embedded audio pictures, see \ref CoverArtImageProvider
+    static const QString ThumbnailPool;  //!< image thumbnails, see \ref ThumbnailImageProvider
+
+private:
+    int             defaultConcurrency(const QString &name) const;
+
+private:
+    mutable QMutex                   m_mutex;
+    QHash<QString, IOWorkerThread *> m_pools;
+    QHash<QString, int>              m_concurrency;  //!< set by \ref setPoolConcurrency()
+};
+
+#endif // IOSCHEDULER_H
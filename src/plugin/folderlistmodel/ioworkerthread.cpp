@@ -33,14 +33,15 @@
 
 
 /*!
-  Hosts a thread, lives on the main thread.
+  Hosts a pool of threads, lives on the main thread.
 
-  Responsible for relaying interaction between the main thread and an IOWorkerThread.
+  Responsible for relaying interaction between the main thread and the IORequestWorker threads,
+  at most \a maxThreads requests from this pool run at the same time.
  */
-IOWorkerThread::IOWorkerThread(QObject *parent) :
+IOWorkerThread::IOWorkerThread(int maxThreads, QObject *parent) :
     QObject(parent)
 {
-    mWorker.start(QThread::IdlePriority);
+    setMaxThreads(maxThreads);
 }
 
 /*!
@@ -48,8 +49,11 @@ IOWorkerThread::IOWorkerThread(QObject *parent) :
  */
 IOWorkerThread::~IOWorkerThread()
 {
-    mWorker.exit();
-    mWorker.wait();
+    mQueue.quit();
+    foreach (IORequestWorker *worker, mWorkers) {
+        worker->wait();
+    }
+    qDeleteAll(mWorkers);
 }
 
 /*!
@@ -59,6 +63,54 @@ IOWorkerThread::~IOWorkerThread()
  */
 bool IOWorkerThread::addRequest(IORequest *request)
 {
-    mWorker.addRequest(request);
+    mQueue.enqueue(request);
     return true;
 }
+
+/*!
+  Sets the pool concurrency, it can only grow: threads already running are kept.
+ */
+void IOWorkerThread::setMaxThreads(int maxThreads)
+{
+    while (mWorkers.count() < maxThreads) {
+        IORequestWorker *worker = new IORequestWorker(&mQueue);
+        mWorkers.append(worker);
+        worker->start(QThread::IdlePriority);
+    }
+}
+
+/*!
+  See IORequestQueue::setLastInFirstOut().
+ */
+void IOWorkerThread::setLastInFirstOut(bool lifo)
+{
+    mQueue.setLastInFirstOut(lifo);
+}
+
+int IOWorkerThread::maxThreads() const
+{
+    return mWorkers.count();
+}
+
+/*!
+  Number of requests waiting for a free thread.
+ */
+int IOWorkerThread::queueDepth() const
+{
+    return mQueue.depth();
+}
+
+int IOWorkerThread::maxQueueDepth() const
+{
+    return mQueue.maxDepth();
+}
+
+int IOWorkerThread::runningRequests() const
+{
+    return mQueue.running();
+}
+
+qint64 IOWorkerThread::processedRequests() const
+{
+    return mQueue.processed();
+}
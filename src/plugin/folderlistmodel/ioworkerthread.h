@@ -34,6 +34,7 @@
 
 #include <QObject>
 #include <QThread>
+#include <QList>
 
 #include "iorequestworker.h"
 
@@ -41,12 +42,21 @@ class IOWorkerThread : public QObject
 {
     Q_OBJECT
 public:
-    explicit IOWorkerThread(QObject *parent = 0);
+    explicit IOWorkerThread(int maxThreads = 1, QObject *parent = 0);
     virtual ~IOWorkerThread();
     bool addRequest(IORequest *request);
 
+    void setMaxThreads(int maxThreads);
+    void setLastInFirstOut(bool lifo);
+    int  maxThreads() const;
+    int  queueDepth() const;
+    int  maxQueueDepth() const;
+    int  runningRequests() const;
+    qint64 processedRequests() const;
+
 private:
-    IORequestWorker mWorker;
+    IORequestQueue           mQueue;
+    QList<IORequestWorker *> mWorkers;
 };
 
 #endif // IOWORKERTHREAD_H
@@ -0,0 +1,60 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: itemstatresolver.cpp
+ * Date: 17/10/2026
+ */
+
+#include "itemstatresolver.h"
+
+#include <QDebug>
+
+ItemStatResolver::ItemStatResolver(const DirItemInfoList &items)
+    : IORequest()
+    , m_items(items)
+{
+    m_type     = ItemStat;
+    // these are the rows on the screen
+    m_priority = RefreshPriority;
+}
+
+void ItemStatResolver::run()
+{
+    DirItemInfoList batch;
+    batch.reserve(ITEM_STAT_RESOLVER_BATCH_SIZE);
+    for (int counter = 0; counter < m_items.count(); ++counter) {
+        if (isCancelled()) {
+            return;
+        }
+        // resolvePendingStat() writes into this copy, which detaches it from the GUI thread rows
+        DirItemInfo item(m_items.at(counter));
+        item.resolvePendingStat();
+        batch.append(item);
+        if (batch.count() == ITEM_STAT_RESOLVER_BATCH_SIZE) {
+            emit resolved(batch);
+            batch.clear();
+        }
+    }
+
+#if DEBUG_MESSAGES
+    qDebug() << Q_FUNC_INFO << "stat'ed" << m_items.count() << "items";
+#endif
+
+    if (!batch.isEmpty()) {
+        emit resolved(batch);
+    }
+    emit finished();
+}
@@ -0,0 +1,53 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: itemstatresolver.h
+ * Date: 17/10/2026
+ */
+
+#ifndef ITEMSTATRESOLVER_H
+#define ITEMSTATRESOLVER_H
+
+#include "iorequest.h"
+
+/*!
+ *  Number of items \ref ItemStatResolver stats before sending them
+ */
+#define ITEM_STAT_RESOLVER_BATCH_SIZE   32
+
+/*!
+ * \brief The ItemStatResolver class does the stat() of items listed with only names and types
+ *
+ *  It is the second half of a lazy listing (\ref IORequestLoader::setLazyStat()), \ref DirModel
+ *  asks for the rows being shown, or for all of them before sorting by size or date.
+ *  Items are sent back in batches by \ref resolved() and \ref finished() is emitted at the end.
+ */
+class ItemStatResolver : public IORequest
+{
+    Q_OBJECT
+public:
+    explicit ItemStatResolver(const DirItemInfoList &items);
+    void run();
+
+signals:
+    void resolved(const DirItemInfoList &items);
+    void finished();
+
+private:
+    DirItemInfoList  m_items;
+};
+
+#endif // ITEMSTATRESOLVER_H
@@ -41,18 +41,20 @@
 
 #include "location.h"
 #include "ioworkerthread.h"
+#include "ioscheduler.h"
+#include "iorequest.h"
 #include "netauthenticationdata.h"
 
 #include <QDebug>
 
-Q_GLOBAL_STATIC(IOWorkerThread, ioWorkerThread)
-
 
 Location::Location(int type, QObject *parent)
     : QObject(parent)
     , m_info(0)
     , m_type(type)
     , m_usingExternalWatcher(false)
+    , m_sortFunction(0)
+    , m_lazyStat(false)
 {
 
 }
@@ -114,9 +116,22 @@ void Location::stopWorking()
 }
 
 
+/*!
+ * \brief Location::workerThread() returns the pool this Location sends its requests to
+ */
 IOWorkerThread *Location::workerThread() const
 {
-    return ioWorkerThread();
+    return IOScheduler::instance()->pool(ioPoolName());
+}
+
+/*!
+ * \brief Location::ioPoolName() name of the \ref IOScheduler pool used by this Location
+ *
+ *  Network Locations use a pool per remote host, see \ref NetworkLocation::ioPoolName()
+ */
+QString Location::ioPoolName() const
+{
+    return isTrashDisk() ? IOScheduler::TrashPool : IOScheduler::LocalDiskPool;
 }
 
 
@@ -130,6 +145,18 @@ void Location::fetchExternalChanges(const QString &path,
     Q_UNUSED(dirFilter);
 }
 
+//providing an empty method
+void Location::fetchExternalEntryChanges(const QString &path,
+                                         const QStringList &names,
+                                         const DirItemInfoList &list,
+                                         QDir::Filters dirFilter)
+{
+    Q_UNUSED(path);
+    Q_UNUSED(names);
+    Q_UNUSED(list);
+    Q_UNUSED(dirFilter);
+}
+
 //======================================================================================================
 /*!
  * \brief Location::setUsingExternalWatcher() Default implementation sets nothing
@@ -276,21 +303,74 @@ DirItemInfo *Location::validateUrlPath(const QString &uPath)
 }
 
 
-void Location::fetchItems(QDir::Filters dirFilter, bool recursive)
+void Location::fetchItems(QDir::Filters dirFilter, bool recursive, IORequest::Priority priority)
 {
+    cancelFetch();
     //it should never happen here
     if (m_info->needsAuthentication()) {
         emit needsAuthentication(currentAuthenticationUser(), m_info->absoluteFilePath());
     } else {
         DirListWorker *dlw  = newListWorker(m_info->absoluteFilePath(), dirFilter, recursive);
-        connect(dlw,  SIGNAL(itemsAdded(DirItemInfoList)),
-                this, SIGNAL(itemsAdded(DirItemInfoList)));
-        connect(dlw,  SIGNAL(workerFinished()),
-                this,     SIGNAL(itemsFetched()));
-        workerThread()->addRequest(dlw);
+        addListRequest(dlw, priority);
     }
 }
 
+/*!
+ * \brief Location::cancelFetch() cancels all workers created by the last \ref fetchItems()
+ *
+ *  A new token is created, so workers added after this call belong to a new fetch.
+ */
+void Location::cancelFetch()
+{
+    m_fetchToken.cancel();
+    m_fetchToken = IORequestCancelToken();
+}
+
+/*!
+ * \brief Location::setSortFunction() sets the order of the items sent by \ref itemsAdded()
+ */
+void Location::setSortFunction(CompareFunction compare)
+{
+    m_sortFunction = compare;
+}
+
+/*!
+ * \brief Location::setLazyStat() when \a lazy is true the listing brings only names and types
+ *
+ *  See \ref IORequestLoader::setLazyStat(), Locations that do not read local folders ignore it.
+ */
+void Location::setLazyStat(bool lazy)
+{
+    m_lazyStat = lazy;
+}
+
+/*!
+ * \brief Location::addListRequest() queues a \ref DirListWorker that belongs to the current fetch
+ *
+ *  Results are relayed only while the fetch is not cancelled, it also discards
+ *  results queued to this thread before \ref cancelFetch() was called.
+ */
+void Location::addListRequest(DirListWorker *worker, IORequest::Priority priority)
+{
+    const IORequestCancelToken token = m_fetchToken;
+    worker->setCancelToken(token);
+    worker->setPriority(priority);
+    worker->setSortFunction(m_sortFunction);
+    worker->setLazyStat(m_lazyStat);
+
+    connect(worker, &DirListWorker::itemsAdded, this, [this, token](const DirItemInfoList & files) {
+        if (!token.isCancelled()) {
+            emit itemsAdded(files);
+        }
+    });
+    connect(worker, &DirListWorker::workerFinished, this, [this, token]() {
+        if (!token.isCancelled()) {
+            emit itemsFetched();
+        }
+    });
+    workerThread()->addRequest(worker);
+}
+
 /*
  *   Each Location should have its implementation if it is possible
  */
@@ -24,6 +24,7 @@
 
 #include "diriteminfo.h"
 #include "locationitemdiriterator.h"
+#include "iorequest.h"
 
 #include <QObject>
 #include <QDirIterator>
@@ -74,14 +75,19 @@ protected:
     explicit Location( int type, QObject *parent = 0);
 
     IOWorkerThread *workerThread() const;
+    virtual QString ioPoolName() const;
+    void            addListRequest(DirListWorker *worker, IORequest::Priority priority);
+
+public:
+    void            setSortFunction(CompareFunction compare);
+    void            setLazyStat(bool lazy);
 
 signals:
     void     itemsAdded(const DirItemInfoList &files);
     void     itemsFetched();
     void     extWatcherPathChanged(const QString &);
-    void     extWatcherItemRemoved(const DirItemInfo &);
-    void     extWatcherItemChanged(const DirItemInfo &);
-    void     extWatcherItemAdded(const   DirItemInfo &);
+    void     extWatcherEntriesChanged(const QString &path, const QStringList &names);
+    void     extWatcherChangesFound(const DirItemChangeSet &changes);
     void     extWatcherChangesFetched(int);
     void     needsAuthentication(const QString &user, const QString &urlPath);
 
@@ -189,8 +195,19 @@ public:
      *
      * \param dirFilter   current Filter
      * \param recursive   should get the content all sub dirs or not, (hardly ever it is true)
+     * \param priority    \ref IORequest::NavigationPriority or \ref IORequest::RefreshPriority
+     *
+     * A fetch still running is cancelled, its results that were not delivered yet are discarded.
+     */
+    virtual void        fetchItems(QDir::Filters dirFilter, bool recursive = false,
+                                   IORequest::Priority priority = IORequest::NavigationPriority);
+
+    /*!
+     * \brief cancelFetch() cancels the fetch started by \ref fetchItems(), if any
+     *
+     *  Neither \ref itemsAdded() nor \ref itemsFetched() are emitted for a cancelled fetch.
      */
-    virtual void        fetchItems(QDir::Filters dirFilter, bool recursive = false);
+    void                cancelFetch();
 
     /*!
      * \brief refreshInfo() It must refresh the DirItemInfo
@@ -244,6 +261,10 @@ public: //virtual
     virtual void        fetchExternalChanges(const QString &urlPath,
                                              const DirItemInfoList &list,
                                              QDir::Filters dirFilter) ;
+    virtual void        fetchExternalEntryChanges(const QString &urlPath,
+                                                  const QStringList &names,
+                                                  const DirItemInfoList &list,
+                                                  QDir::Filters dirFilter);
     virtual void        setInfoItem(const DirItemInfo &itemInfo);
     virtual void        setInfoItem(DirItemInfo *itemInfo);
     virtual bool        isRoot() const;
@@ -273,6 +294,9 @@ protected:
     DirItemInfo                 *m_info;
     int                          m_type;
     bool                         m_usingExternalWatcher;
+    CompareFunction              m_sortFunction; //!< passed to the \ref DirListWorker objects
+    bool                         m_lazyStat;     //!< passed to the \ref DirListWorker objects
+    IORequestCancelToken         m_fetchToken;  //!< shared by all workers of the current \ref fetchItems()
 
 #if defined(REGRESSION_TEST_FOLDERLISTMODEL)
     friend class TestDirModel;
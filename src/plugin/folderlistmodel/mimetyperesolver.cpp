@@ -0,0 +1,58 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: mimetyperesolver.cpp
+ * Date: 17/10/2026
+ */
+
+#include "mimetyperesolver.h"
+
+#include <QDebug>
+
+MimeTypeResolver::MimeTypeResolver(const DirItemInfoList &items)
+    : IORequest()
+    , m_items(items)
+{
+    m_type     = MimeTypeResolve;
+    m_priority = PrefetchPriority;
+}
+
+void MimeTypeResolver::run()
+{
+    DirItemInfoList batch;
+    batch.reserve(MIME_TYPE_RESOLVER_BATCH_SIZE);
+    for (int counter = 0; counter < m_items.count(); ++counter) {
+        if (isCancelled()) {
+            return;
+        }
+        // resolveMimeTypeFromContent() writes into this copy, which detaches it from the GUI thread rows
+        DirItemInfo item(m_items.at(counter));
+        item.resolveMimeTypeFromContent();
+        batch.append(item);
+        if (batch.count() == MIME_TYPE_RESOLVER_BATCH_SIZE) {
+            emit resolved(batch);
+            batch.clear();
+        }
+    }
+
+#if DEBUG_MESSAGES
+    qDebug() << Q_FUNC_INFO << "resolved" << m_items.count() << "mime types";
+#endif
+
+    if (!batch.isEmpty()) {
+        emit resolved(batch);
+    }
+}
@@ -0,0 +1,52 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: mimetyperesolver.h
+ * Date: 17/10/2026
+ */
+
+#ifndef MIMETYPERESOLVER_H
+#define MIMETYPERESOLVER_H
+
+#include "iorequest.h"
+
+/*!
+ *  Number of items \ref MimeTypeResolver reads before sending them
+ */
+#define MIME_TYPE_RESOLVER_BATCH_SIZE   64
+
+/*!
+ * \brief The MimeTypeResolver class reads the content of local files to find their mime types
+ *
+ *  It is the background pass of \ref DirItemInfo::MimeTypeFromExtensionThenContent and
+ *  \ref DirItemInfo::MimeTypeFromContent, items are sent back in batches by \ref resolved(),
+ *  \ref DirModel copies their mime types into its own items.
+ */
+class MimeTypeResolver : public IORequest
+{
+    Q_OBJECT
+public:
+    explicit MimeTypeResolver(const DirItemInfoList &items);
+    void run();
+
+signals:
+    void resolved(const DirItemInfoList &items);
+
+private:
+    DirItemInfoList  m_items;
+};
+
+#endif // MIMETYPERESOLVER_H
@@ -0,0 +1,156 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: namefiltermatcher.cpp
+ * Date: 17/10/2026
+ */
+
+#include "namefiltermatcher.h"
+
+NameFilterMatcher::NameFilterMatcher()
+    : m_matchesAll(true)
+    , m_maxSuffixLength(0)
+{
+}
+
+NameFilterMatcher::NameFilterMatcher(const QStringList &patterns)
+    : m_matchesAll(false)
+    , m_maxSuffixLength(0)
+{
+    setPatterns(patterns);
+}
+
+bool NameFilterMatcher::hasWildcards(const QString &text)
+{
+    for (int counter = 0; counter < text.length(); ++counter) {
+        const QChar c = text.at(counter);
+        if (c == QLatin1Char('*') || c == QLatin1Char('?') || c == QLatin1Char('[')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*!
+ * \brief NameFilterMatcher::wildcardToRegularExpression() converts a QRegExp::Wildcard pattern
+ */
+QString NameFilterMatcher::wildcardToRegularExpression(const QString &pattern)
+{
+    QString ret;
+    const int length = pattern.length();
+    for (int counter = 0; counter < length; ++counter) {
+        const QChar c = pattern.at(counter);
+        if (c == QLatin1Char('*')) {
+            ret += QLatin1String(".*");
+        } else if (c == QLatin1Char('?')) {
+            ret += QLatin1Char('.');
+        } else if (c == QLatin1Char('[')) {
+            // same as QRegExp: "[^" negates the set and a leading ']' is part of it
+            int end = counter + 1;
+            if (end < length && pattern.at(end) == QLatin1Char('^')) {
+                ++end;
+            }
+            if (end < length && pattern.at(end) == QLatin1Char(']')) {
+                ++end;
+            }
+            end = pattern.indexOf(QLatin1Char(']'), end);
+            if (end == -1) {
+                ret += QLatin1String("\\[");
+            } else {
+                ret += QLatin1Char('[');
+                for (++counter; counter < end; ++counter) {
+                    const QChar setChar = pattern.at(counter);
+                    if (setChar == QLatin1Char('\\') || setChar == QLatin1Char('[')) {
+                        ret += QLatin1Char('\\');
+                    }
+                    ret += setChar;
+                }
+                ret += QLatin1Char(']');
+            }
+        } else {
+            ret += QRegularExpression::escape(QString(c));
+        }
+    }
+    return ret;
+}
+
+/*!
+ * \brief NameFilterMatcher::setPatterns() compiles \a patterns, an empty list matches nothing
+ */
+void NameFilterMatcher::setPatterns(const QStringList &patterns)
+{
+    m_matchesAll      = false;
+    m_maxSuffixLength = 0;
+    m_suffixes.clear();
+    m_names.clear();
+    m_prefixes.clear();
+    m_others = QRegularExpression();
+
+    QStringList others;
+    foreach (const QString &pattern, patterns) {
+        if (pattern == QLatin1String("*")) {
+            m_matchesAll = true;
+        } else if (pattern.startsWith(QLatin1String("*.")) && !hasWildcards(pattern.mid(1))) {
+            const QString suffix = pattern.mid(1).toLower();
+            m_suffixes.insert(suffix);
+            m_maxSuffixLength = qMax(m_maxSuffixLength, suffix.length());
+        } else if (!hasWildcards(pattern)) {
+            m_names.insert(pattern.toLower());
+        } else if (pattern.endsWith(QLatin1Char('*')) && !hasWildcards(pattern.left(pattern.length() - 1))) {
+            m_prefixes.append(pattern.left(pattern.length() - 1));
+        } else {
+            others.append(QLatin1String("(?:") + wildcardToRegularExpression(pattern) + QLatin1Char(')'));
+        }
+    }
+
+    if (!others.isEmpty()) {
+        m_others.setPattern(QLatin1String("\\A(?:") + others.join(QLatin1Char('|')) + QLatin1String(")\\z"));
+        m_others.setPatternOptions(QRegularExpression::CaseInsensitiveOption |
+                                   QRegularExpression::DotMatchesEverythingOption);
+        m_others.optimize();
+    }
+}
+
+bool NameFilterMatcher::matches(const QString &fileName) const
+{
+    if (m_matchesAll) {
+        return true;
+    }
+
+    if (!m_suffixes.isEmpty()) {
+        // the suffix may contain dots as in "*.tar.gz"
+        const int minPos = qMax(0, fileName.length() - m_maxSuffixLength);
+        int dot = fileName.lastIndexOf(QLatin1Char('.'));
+        while (dot >= minPos) {
+            if (m_suffixes.contains(fileName.mid(dot).toLower())) {
+                return true;
+            }
+            dot = dot > 0 ? fileName.lastIndexOf(QLatin1Char('.'), dot - 1) : -1;
+        }
+    }
+
+    if (!m_names.isEmpty() && m_names.contains(fileName.toLower())) {
+        return true;
+    }
+
+    foreach (const QString &prefix, m_prefixes) {
+        if (fileName.startsWith(prefix, Qt::CaseInsensitive)) {
+            return true;
+        }
+    }
+
+    return !m_others.pattern().isEmpty() && m_others.match(fileName).hasMatch();
+}
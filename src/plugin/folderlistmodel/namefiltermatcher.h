@@ -0,0 +1,62 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: namefiltermatcher.h
+ * Date: 17/10/2026
+ */
+
+#ifndef NAMEFILTERMATCHER_H
+#define NAMEFILTERMATCHER_H
+
+#include <QStringList>
+#include <QSet>
+#include <QRegularExpression>
+
+/*!
+ * \brief The NameFilterMatcher class matches file names against a list of wildcard patterns
+ *
+ *  It gives the same results as QRegExp(pattern, Qt::CaseInsensitive, QRegExp::Wildcard).exactMatch()
+ *  for any of the patterns, but the patterns are compiled once by \ref setPatterns():
+ *    \li "*" matches everything
+ *    \li "*.ext" patterns become a set of lower case suffixes
+ *    \li names without wildcards become a set of lower case names
+ *    \li "prefix*" patterns become a list of prefixes
+ *    \li all other patterns are joined into a single regular expression
+ */
+class NameFilterMatcher
+{
+public:
+    NameFilterMatcher();
+    explicit NameFilterMatcher(const QStringList &patterns);
+
+    void          setPatterns(const QStringList &patterns);
+    bool          matches(const QString &fileName) const;
+    inline bool   matchesAll() const { return m_matchesAll; }
+
+private:
+    static bool    hasWildcards(const QString &text);
+    static QString wildcardToRegularExpression(const QString &pattern);
+
+private:
+    bool               m_matchesAll;
+    QSet<QString>      m_suffixes;      //!< ".ext", lower case
+    int                m_maxSuffixLength;
+    QSet<QString>      m_names;         //!< lower case
+    QStringList        m_prefixes;
+    QRegularExpression m_others;        //!< invalid when there are no other patterns
+};
+
+#endif // NAMEFILTERMATCHER_H
@@ -58,7 +58,7 @@ DirItemInfoList NetworkListWorker::getNetworkContent()
     m_dirIterator->load();
     bool is_parent_of_smb_url = m_parentItemInfo != 0
                                 && m_parentItemInfo->urlPath().startsWith(LocationUrl::SmbURL);
-    while (m_dirIterator->hasNext()) {
+    while (m_dirIterator->hasNext() && !isCancelled()) {
         m_mainItemInfo->setFile(m_dirIterator->next());
         if (is_parent_of_smb_url) {
             setSmbItemAttributes();
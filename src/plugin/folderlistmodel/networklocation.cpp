@@ -23,6 +23,9 @@
 #include "networklistworker.h"
 #include "locationitemdiriterator.h"
 #include "diriteminfo.h"
+#include "ioscheduler.h"
+
+#include <QUrl>
 
 NetworkLocation::NetworkLocation(int type, QObject *parent): Location(type, parent)
 {
@@ -42,3 +45,14 @@ DirListWorker *NetworkLocation::newListWorker(const QString &urlPath, QDir::Filt
     // the NetworkListWorker object takes ownership of baseitemInfo and also creates its own copy of m_info
     return new NetworkListWorker(dirIterator, baseitemInfo, m_info);
 }
+
+/*!
+ * \brief NetworkLocation::ioPoolName() each remote host has its own pool
+ *
+ *  A slow or unreachable host does not block browsing other hosts or the local disk.
+ */
+QString NetworkLocation::ioPoolName() const
+{
+    QUrl url(urlPath());
+    return IOScheduler::networkPoolName(url.scheme(), url.host());
+}
@@ -84,6 +84,8 @@ public:
     virtual DirListWorker *newListWorker(const QString &urlPath,
                                          QDir::Filters filter,
                                          const bool isRecursive);
+protected:
+    virtual QString ioPoolName() const;
 };
 
 #endif // NETWORKLOCATION_H
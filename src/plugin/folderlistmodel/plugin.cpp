@@ -44,6 +44,11 @@ void NemoFolderListModelPlugin::initializeEngine(QmlEngine *engine, const char *
     engine->addImageProvider(QLatin1String("cover-art-full"), new CoverArtFullImageProvider);
 #endif //DO_NOT_USE_TAG_LIB
 
+    // the application may already use an external thumbnailer with the same id
+    if (engine->imageProvider(QLatin1String("thumbnailer")) == 0) {
+        engine->addImageProvider(QLatin1String("thumbnailer"), new ThumbnailImageProvider);
+    }
+
     Q_UNUSED(uri);
     Q_UNUSED(engine);
 }
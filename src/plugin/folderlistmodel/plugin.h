@@ -35,6 +35,7 @@
 #include "dirmodel.h"
 #include "dirselection.h"
 #include "smbusershare.h"
+#include "thumbnailprovider.h"
 
 #include <QtGlobal>
 
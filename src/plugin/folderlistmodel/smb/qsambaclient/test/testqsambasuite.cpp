@@ -424,7 +424,6 @@ void TestQSambaSuite::positive_itemInfoShare()
     QCOMPARE(dirinfo.isReadable(), true);
     QCOMPARE(dirinfo.isWritable(), true);
     QCOMPARE(dirinfo.isExecutable(), true);
-    QCOMPARE(dirinfo.isSelected(), false);
     QCOMPARE(dirinfo.isSharedDir(), false);
     QCOMPARE(dirinfo.isRoot(), false);
     QCOMPARE(dirinfo.isHost(),   false);
@@ -463,7 +462,6 @@ void TestQSambaSuite::positive_itemInfoCommonPermissions()
     QCOMPARE(fileinfo.isReadable(), true);
     QCOMPARE(fileinfo.isWritable(), true);
     QCOMPARE(fileinfo.isExecutable(), false);
-    QCOMPARE(fileinfo.isSelected(), false);
     QCOMPARE(fileinfo.isSharedDir(), false);
     QCOMPARE(fileinfo.isRoot(), false);
     QCOMPARE(fileinfo.isRemote(), true);
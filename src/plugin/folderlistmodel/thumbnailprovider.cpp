@@ -0,0 +1,202 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: thumbnailprovider.cpp
+ * Date: 17/10/2026
+ */
+
+#include "thumbnailprovider.h"
+#include "ioscheduler.h"
+#include "fmutil.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <QDebug>
+
+namespace {
+const char thumbUriKey[]   = "Thumb::URI";
+const char thumbMTimeKey[] = "Thumb::MTime";
+const char thumbFailDir[]  = "/fail/folderlistmodel/";
+}
+
+
+ThumbnailLoader::ThumbnailLoader(const QString &path, const QSize &bounds, const QString &thumbnailsDir)
+    : ImageLoader(ThumbnailLoad)
+    , m_path(path)
+    , m_bounds(bounds)
+    , m_thumbnailsDir(thumbnailsDir)
+{
+}
+
+void ThumbnailLoader::run()
+{
+    QFileInfo fi(m_path);
+    const uint mtime        = fi.lastModified().toTime_t();
+    const int  boundsMax    = qMax(m_bounds.width(), m_bounds.height());
+    const int  thumbnailSize = boundsMax <= THUMBNAIL_NORMAL_SIZE ? THUMBNAIL_NORMAL_SIZE
+                                                                 : THUMBNAIL_LARGE_SIZE;
+    QImage img;
+    if (boundsMax > THUMBNAIL_LARGE_SIZE || m_thumbnailsDir.isEmpty()) {
+        img = decode(m_path, m_bounds);
+    } else {
+        const QString uri       = QString::fromLatin1(QUrl::fromLocalFile(fi.absoluteFilePath()).toEncoded());
+        const QString thumbFile = thumbnailFileName(m_thumbnailsDir, uri, thumbnailSize);
+        img = readThumbnail(thumbFile, uri, mtime);
+        const QString failFile = failFileName(m_thumbnailsDir, uri);
+        // a file that could not be decoded is not tried again until it changes
+        if (img.isNull() && !isCancelled() && readThumbnail(failFile, uri, mtime).isNull()) {
+            img = decode(m_path, QSize(thumbnailSize, thumbnailSize));
+            if (img.isNull()) {
+                if (fi.exists()) {
+                    QImage failed(1, 1, QImage::Format_ARGB32);
+                    failed.fill(Qt::transparent);
+                    writeThumbnail(failFile, uri, mtime, failed);
+                }
+            } else if (!writeThumbnail(thumbFile, uri, mtime, img)) {
+                qWarning() << Q_FUNC_INFO << "could not save thumbnail" << thumbFile;
+            }
+        }
+        const QSize size = FMUtil::fitSize(img.size(), m_bounds);
+        if (!img.isNull() && size != img.size()) {
+            img = img.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+        }
+    }
+    if (!isCancelled()) {
+        emit loaded(img);
+    }
+}
+
+/*!
+ * \brief ThumbnailLoader::thumbnailFileName() returns "<thumbnailsDir>/<normal|large>/<md5 of uri>.png"
+ */
+QString ThumbnailLoader::thumbnailFileName(const QString &thumbnailsDir, const QString &uri, int thumbnailSize)
+{
+    return thumbnailsDir
+           + (thumbnailSize <= THUMBNAIL_NORMAL_SIZE ? QLatin1String("/normal/") : QLatin1String("/large/"))
+           + QString::fromLatin1(QCryptographicHash::hash(uri.toUtf8(), QCryptographicHash::Md5).toHex())
+           + QLatin1String(".png");
+}
+
+/*!
+ * \brief ThumbnailLoader::failFileName() returns "<thumbnailsDir>/fail/folderlistmodel/<md5 of uri>.png"
+ */
+QString ThumbnailLoader::failFileName(const QString &thumbnailsDir, const QString &uri)
+{
+    return thumbnailsDir + QLatin1String(thumbFailDir)
+           + QString::fromLatin1(QCryptographicHash::hash(uri.toUtf8(), QCryptographicHash::Md5).toHex())
+           + QLatin1String(".png");
+}
+
+/*!
+ * \brief ThumbnailLoader::readThumbnail() reads \a fileName when it is the thumbnail of \a uri at \a mtime
+ * \return a null image when there is no valid thumbnail
+ */
+QImage ThumbnailLoader::readThumbnail(const QString &fileName, const QString &uri, uint mtime)
+{
+    QImageReader reader(fileName, "png");
+    // text chunks come before the image data, the image is only decoded when they match
+    if (!reader.canRead()
+            || reader.text(QLatin1String(thumbUriKey)) != uri
+            || reader.text(QLatin1String(thumbMTimeKey)) != QString::number(mtime)) {
+        return QImage();
+    }
+    return reader.read();
+}
+
+/*!
+ * \brief ThumbnailLoader::writeThumbnail() saves \a thumbnail with the attributes required by the standard
+ *
+ *  The directory is only accessible by the user and the file is written atomically.
+ */
+bool ThumbnailLoader::writeThumbnail(const QString &fileName, const QString &uri, uint mtime,
+                                     const QImage &thumbnail)
+{
+    const QString dir = QFileInfo(fileName).absolutePath();
+    if (!QFileInfo::exists(dir)) {
+        QDir().mkpath(dir);
+        QFile::setPermissions(dir, QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner);
+    }
+    QSaveFile file(fileName);
+    if (!file.open(QFile::WriteOnly)) {
+        return false;
+    }
+    file.setPermissions(QFile::ReadOwner | QFile::WriteOwner);
+    QImageWriter writer(&file, "png");
+    writer.setText(QLatin1String(thumbUriKey), uri);
+    writer.setText(QLatin1String(thumbMTimeKey), QString::number(mtime));
+    writer.setText(QLatin1String("Software"), QLatin1String("folderlistmodel"));
+    return writer.write(thumbnail) && file.commit();
+}
+
+/*!
+ * \brief ThumbnailLoader::decode() decodes \a path at a size that fits \a bounds, see \ref FMUtil::fitSize()
+ */
+QImage ThumbnailLoader::decode(const QString &path, const QSize &bounds)
+{
+    QImageReader reader(path);
+    reader.setAutoTransform(true);
+    QSize size = reader.size();
+    // EXIF orientation swaps the sides after decoding, setScaledSize() refers to the stored image
+    const bool rotated = reader.transformation() & QImageIOHandler::TransformationRotate90;
+    QSize fitted = FMUtil::fitSize(rotated ? size.transposed() : size, bounds);
+    if (fitted.isValid()) {
+        reader.setScaledSize(rotated ? fitted.transposed() : fitted);
+    }
+    return reader.read();
+}
+
+
+ThumbnailImageProvider::ThumbnailImageProvider()
+    : QQuickAsyncImageProvider()
+    , m_thumbnailsDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+                      + QLatin1String("/thumbnails"))
+{
+}
+
+QQuickImageResponse *ThumbnailImageProvider::requestImageResponse(const QString &id,
+                                                                  const QSize &requestedSize)
+{
+    // the id is "file:///path", a plain path is also accepted
+    const QUrl url(id);
+    const QString path = url.isLocalFile() ? url.toLocalFile() : id;
+
+    QSize bounds = requestedSize;
+    if (bounds.width() <= 0 && bounds.height() <= 0) {
+        bounds = QSize(THUMBNAIL_DEFAULT_SIZE, THUMBNAIL_DEFAULT_SIZE);
+    }
+    return new ImageLoaderResponse(new ThumbnailLoader(path, bounds, m_thumbnailsDir),
+                                   IOScheduler::ThumbnailPool);
+}
+
+/*!
+ * \brief ThumbnailImageProvider::setThumbnailsDir() sets the thumbnails cache, an empty \a dir disables it
+ */
+void ThumbnailImageProvider::setThumbnailsDir(const QString &dir)
+{
+    m_thumbnailsDir = dir;
+}
+
+QString ThumbnailImageProvider::thumbnailsDir() const
+{
+    return m_thumbnailsDir;
+}
@@ -0,0 +1,98 @@
+/**************************************************************************
+ *
+ * Copyright 2026 Canonical Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * File: thumbnailprovider.h
+ * Date: 17/10/2026
+ */
+
+#ifndef THUMBNAILPROVIDER_H
+#define THUMBNAILPROVIDER_H
+
+#include "imageloader.h"
+
+#include <QQuickImageProvider>
+#include <QImage>
+#include <QSize>
+
+/*!
+ *  Sizes of the freedesktop.org thumbnail directories
+ */
+#define THUMBNAIL_NORMAL_SIZE     128
+#define THUMBNAIL_LARGE_SIZE      256
+
+/*!
+ *  Size used when QML does not set a sourceSize
+ */
+#define THUMBNAIL_DEFAULT_SIZE    THUMBNAIL_NORMAL_SIZE
+
+
+/*!
+ * \brief The ThumbnailLoader class makes the thumbnail of a local image file
+ *
+ *  It follows the freedesktop.org Thumbnail Managing Standard: thumbnails are PNG files named
+ *  after the MD5 of the file URI in the "normal" (128px) or "large" (256px) directory of
+ *  \ref ThumbnailImageProvider::thumbnailsDir(), a thumbnail is valid while its "Thumb::MTime"
+ *  is the modification time of the file.
+ *
+ *  When there is no valid thumbnail the image is decoded straight at the thumbnail size
+ *  by QImageReader::setScaledSize(), JPEG files then use DCT scaling.
+ *  Sizes bigger than \ref THUMBNAIL_LARGE_SIZE are decoded every time and not saved.
+ *
+ *  Files that cannot be decoded get an empty thumbnail in the "fail/folderlistmodel" directory,
+ *  as the standard describes, and are not decoded again until their modification time changes.
+ */
+class ThumbnailLoader : public ImageLoader
+{
+    Q_OBJECT
+public:
+    ThumbnailLoader(const QString &path, const QSize &bounds, const QString &thumbnailsDir);
+    void run();
+
+    static QString  thumbnailFileName(const QString &thumbnailsDir, const QString &uri, int thumbnailSize);
+    static QString  failFileName(const QString &thumbnailsDir, const QString &uri);
+    static QImage   readThumbnail(const QString &fileName, const QString &uri, uint mtime);
+    static bool     writeThumbnail(const QString &fileName, const QString &uri, uint mtime,
+                                   const QImage &thumbnail);
+    static QImage   decode(const QString &path, const QSize &bounds);
+
+private:
+    QString  m_path;
+    QSize    m_bounds;
+    QString  m_thumbnailsDir;
+};
+
+
+/*!
+ * \brief The ThumbnailImageProvider class provides "image://thumbnailer/file:///path" images
+ *
+ *  Thumbnails are made by the \ref IOScheduler::ThumbnailPool, which runs the latest requests first,
+ *  so the rows being shown get their images before the ones already scrolled through.
+ */
+class ThumbnailImageProvider : public QQuickAsyncImageProvider
+{
+public:
+    ThumbnailImageProvider();
+
+    QQuickImageResponse *requestImageResponse(const QString &id, const QSize &requestedSize);
+
+    void     setThumbnailsDir(const QString &dir);
+    QString  thumbnailsDir() const;
+
+private:
+    QString  m_thumbnailsDir;
+};
+
+#endif // THUMBNAILPROVIDER_H
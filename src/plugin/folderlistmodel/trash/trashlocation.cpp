@@ -176,9 +176,10 @@ void TrashLocation::startExternalFsWatcher()
     }
 }
 
-void TrashLocation::fetchItems(QDir::Filters dirFilter, bool recursive)
+void TrashLocation::fetchItems(QDir::Filters dirFilter, bool recursive, IORequest::Priority priority)
 {
     Q_UNUSED(recursive)
+    cancelFetch();
     if (!m_info->isRoot()) { //any item under the logical trash folder
         //sub items inside Trash do not need external watcher, they will never be updated
         stopExternalFsWatcher();
@@ -186,7 +187,7 @@ void TrashLocation::fetchItems(QDir::Filters dirFilter, bool recursive)
         TrashItemInfo *trashItem = static_cast<TrashItemInfo *> (m_info);
         TrashListWorker *dlw = new TrashListWorker(trashItem->getRootTrashDir(), trashItem->absoluteFilePath(), dirFilter);
 
-        addTrashFetchRequest(dlw);
+        addTrashFetchRequest(dlw, priority);
 
     } else {
         m_currentPaths = allTrashes();
@@ -195,17 +196,15 @@ void TrashLocation::fetchItems(QDir::Filters dirFilter, bool recursive)
         //the trash a is logical folder, its content can be composed by more than one physical folder
         foreach (const QString &trashRootDir, m_currentPaths) {
             TrashListWorker *dlw  = new TrashListWorker(trashRootDir, QTrashUtilInfo::filesTrashDir(trashRootDir), dirFilter);
-            addTrashFetchRequest(dlw);
+            addTrashFetchRequest(dlw, priority);
         }
     }
 }
 
-void TrashLocation::addTrashFetchRequest(TrashListWorker *workerObject)
+void TrashLocation::addTrashFetchRequest(TrashListWorker *workerObject, IORequest::Priority priority)
 {
-    connect(workerObject, SIGNAL(itemsAdded(DirItemInfoList)), this, SIGNAL(itemsAdded(DirItemInfoList)));
-    connect(workerObject, SIGNAL(workerFinished()), this, SIGNAL(itemsFetched()));  //it differs from DiskLocation
-
-    workerThread()->addRequest(workerObject);
+    //it differs from DiskLocation, all workers of the fetch share the same cancel token
+    addListRequest(workerObject, priority);
 }
 
 void TrashLocation::fetchExternalChanges(const QString &urlPath, const DirItemInfoList &list, QDir::Filters dirFilter)
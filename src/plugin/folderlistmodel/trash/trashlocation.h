@@ -35,7 +35,8 @@ public:
     virtual ~TrashLocation();
     virtual bool becomeParent();
     virtual void refreshInfo();
-    virtual void fetchItems(QDir::Filters dirFilter, bool recursive = 0);
+    virtual void fetchItems(QDir::Filters dirFilter, bool recursive = 0,
+                            IORequest::Priority priority = IORequest::NavigationPriority);
     virtual void fetchExternalChanges(const QString &urlPath, const DirItemInfoList &list, QDir::Filters dirFilter) ;
 
     virtual void startWorking();
@@ -69,7 +70,7 @@ public:
     ActionPaths getRestorePairPaths(const DirItemInfo &item) const;
 
 private:
-    void addTrashFetchRequest(TrashListWorker *workerObject);
+    void addTrashFetchRequest(TrashListWorker *workerObject, IORequest::Priority priority);
 
 private:
     ActionPathList m_actionPathList;
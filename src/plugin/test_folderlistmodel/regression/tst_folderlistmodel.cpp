@@ -3,6 +3,11 @@
 #include "tempfiles.h"
 #include "externalfswatcher.h"
 #include "dirselection.h"
+#include "diriteminfostore.h"
+#include "dirlistingsnapshot.h"
+#include "namefiltermatcher.h"
+#include "diskdirscanner.h"
+#include "diskparallelscanner.h"
 #include "qtrashdir.h"
 #include "location.h"
 #include "locationurl.h"
@@ -22,6 +27,7 @@
 #endif
 
 #ifndef DO_NOT_USE_TAG_LIB
+#include "audiometadata.h"
 #include <taglib/attachedpictureframe.h>
 #include <taglib/id3v2tag.h>
 #include <taglib/fileref.h>
@@ -99,6 +105,7 @@ protected slots:
     void slotclipboardChanged();
     void slotError(QString title, QString message);
     void slotExtFsWatcherPathModified(const QString&)     { ++m_extFSWatcherPathModifiedCounter; }
+    void slotExtFsWatcherEntriesModified(const QString&, const QStringList&) { ++m_extFSWatcherPathModifiedCounter; }
     void slotSelectionChanged(int counter)  { m_selectedItemsCounter = counter; }
     void slotSelectionModeChanged(int m)    { m_selectionMode = m;}
     void onDownloadTemporaryComplete(const QString& name) {m_temporaryDownloadName = name;}
@@ -167,6 +174,16 @@ private Q_SLOTS: // test cases
     void modelSingleSelection();
     void modelMultiSelection();   
     void modelSelectionItemsRange();
+    void modelSelectionFollowsInsertedAndRemovedRows();
+    void modelFetchPagesAndRemovePendingItems();
+    void modelRefreshUnchangedDirectory();
+    void modelRefreshModifiedItem();
+    void modelExternalChangeMovesRow();
+    void dirItemInfoStoreRoundTrip();
+    void diskDirScannerMatchesQDirIterator();
+    void diskParallelScannerListsTree();
+    void dirListingSnapshotRoundTrip();
+    void nameFilterMatcherAgainstQRegExp();
 
     void trashDiretories();
 
@@ -1918,7 +1935,18 @@ void TestDirModel::verifyMP3Metadata()
     QCOMPARE(mp3File.isEmpty(),   false);
 
     m_dirModel_01->setReadsMediaMetadata(true);
-    QFileInfo fi(mp3File);
+    DirItemInfo fi = DirItemInfo(QFileInfo(mp3File));
+    AudioMetaDataCache::instance()->clear();
+
+    //tags are read in the IO pool, the first call just queues the file
+    QCOMPARE(m_dirModel_01->getAudioMetaData(fi, DirModel::TrackTitleRole).isValid(),  false);
+    AudioMetaData data;
+    for (int counter = 0; counter < 20 &&
+         !AudioMetaDataCache::instance()->find(fi.absoluteFilePath(), fi.size(), fi.lastModified(), data);
+         ++counter)
+    {
+        QTest::qWait(TIME_TO_REFRESH_DIR);
+    }
 
     QString title  = m_dirModel_01->getAudioMetaData(fi, DirModel::TrackTitleRole).toString();
     QString artist = m_dirModel_01->getAudioMetaData(fi, DirModel::TrackArtistRole).toString();
@@ -2145,8 +2173,11 @@ void TestDirModel::extFsWatcherNoticeChangesWithSameTimestamp()
 {
     bool updateAndSetModificationTime(const QString& filename, QDateTime& desiredTime);
 
+    //DirModel asks for the names, inotify then notifies by entriesModified()
     connect( m_dirModel_01->getExternalFSWatcher(), SIGNAL(pathModified(QString)),
             this,     SLOT(slotExtFsWatcherPathModified(QString)));
+    connect( m_dirModel_01->getExternalFSWatcher(), SIGNAL(entriesModified(QString,QStringList)),
+            this,     SLOT(slotExtFsWatcherEntriesModified(QString,QStringList)));
 
     QString dirName("extFsWatcher_generate_fileswithsameTimeStamp");
     m_deepDir_01 = new DeepDir(dirName,0);
@@ -2424,6 +2455,561 @@ void TestDirModel::modelSelectionItemsRange()
     QCOMPARE(m_selectedItemsCounter,     9);
 }
 
+/*!
+ *  Rows inserted or removed by external changes shift the selected rows,
+ *  70 items make the selection cross the 64 bits word boundary
+ */
+void TestDirModel::modelSelectionFollowsInsertedAndRemovedRows()
+{
+    DirSelection  *selection = m_dirModel_01->selectionObject();
+    QVERIFY(selection != 0);
+
+    connect(selection, SIGNAL(selectionChanged(int)),
+            this,      SLOT(slotSelectionChanged(int)));
+
+    QString dirName("modelSelectionFollowsInsertedAndRemovedRows");
+    m_deepDir_01 = new DeepDir(dirName,0);
+    TempFiles  tmpFiles;
+    const int createdFiles = 70;
+    tmpFiles.addSubDirLevel(dirName);
+    tmpFiles.create(createdFiles);
+
+    m_dirModel_01->setPath(m_deepDir_01->path());
+    QTest::qWait(TIME_TO_REFRESH_DIR);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles);
+
+    selection->setMode(DirSelection::Multi);
+    selection->setIndex(1,  true);
+    selection->setIndex(63, true);
+    QTest::qWait(TIME_TO_REFRESH_DIR);
+    QCOMPARE(m_selectedItemsCounter,     2);
+    QStringList selectedPaths = selection->selectedAbsFilePaths();
+    QCOMPARE(selectedPaths.count(),      2);
+
+    //an item sorted before all others is created outside, selected rows move down
+    TempFiles  firstFile;
+    firstFile.addSubDirLevel(dirName);
+    firstFile.create(QLatin1String("a_first"), 1);
+    QTest::qWait(EX_FS_WATCHER_TIMER_INTERVAL * 2);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles + 1);
+    QList<int> selectedIndexes = selection->selectedIndexes();
+    QCOMPARE(selectedIndexes.count(),    2);
+    QCOMPARE(selectedIndexes.at(0),      2);
+    QCOMPARE(selectedIndexes.at(1),      64);
+    QCOMPARE(selection->selectedAbsFilePaths(), selectedPaths);
+    QCOMPARE(m_dirModel_01->data(m_dirModel_01->index(64, DirModel::IsSelectedRole - DirModel::FileNameRole)).toBool(), true);
+    QCOMPARE(m_dirModel_01->data(m_dirModel_01->index(63, DirModel::IsSelectedRole - DirModel::FileNameRole)).toBool(), false);
+
+    //removing it outside moves them up again
+    QCOMPARE(QFile::remove(firstFile.lastFileCreated()),  true);
+    QTest::qWait(EX_FS_WATCHER_TIMER_INTERVAL * 2);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles);
+    selectedIndexes = selection->selectedIndexes();
+    QCOMPARE(selectedIndexes.count(),    2);
+    QCOMPARE(selectedIndexes.at(0),      1);
+    QCOMPARE(selectedIndexes.at(1),      63);
+    QCOMPARE(selection->selectedAbsFilePaths(), selectedPaths);
+
+    //removing a selected item keeps the other one
+    m_dirModel_01->removeIndex(1);
+    QTest::qWait(TIME_TO_PROCESS);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles - 1);
+    QCOMPARE(m_selectedItemsCounter,     1);
+    selectedIndexes = selection->selectedIndexes();
+    QCOMPARE(selectedIndexes.count(),    1);
+    QCOMPARE(selectedIndexes.at(0),      62);
+    QCOMPARE(selection->selectedAbsFilePaths().first(), selectedPaths.at(1));
+}
+
+/*!
+ *  With fetchPageSize set only one page of rows is exposed, the other items
+ *  are kept aside and they are still updated by external changes
+ */
+void TestDirModel::modelFetchPagesAndRemovePendingItems()
+{
+    QString dirName("modelFetchPagesAndRemovePendingItems");
+    m_deepDir_01 = new DeepDir(dirName,0);
+    TempFiles  tmpFiles;
+    const int createdFiles = 30;
+    const int pageSize     = 10;
+    tmpFiles.addSubDirLevel(dirName);
+    tmpFiles.create(createdFiles);
+
+    m_dirModel_01->setFetchPageSize(pageSize);
+    QCOMPARE(m_dirModel_01->fetchPageSize(),  pageSize);
+    m_dirModel_01->setPath(m_deepDir_01->path());
+    QTest::qWait(TIME_TO_REFRESH_DIR);
+    QCOMPARE(m_dirModel_01->rowCount(),  pageSize);
+    QCOMPARE(m_dirModel_01->canFetchMore(QModelIndex()),  true);
+
+    m_dirModel_01->fetchMore(QModelIndex());
+    QCOMPARE(m_dirModel_01->rowCount(),  pageSize * 2);
+
+    //"tempfile_29" sorts last, it was not exposed yet
+    QStringList created = tmpFiles.createdList();
+    created.sort();
+    QCOMPARE(QFile::remove(created.last()),  true);
+    QTest::qWait(EX_FS_WATCHER_TIMER_INTERVAL * 2);
+    QCOMPARE(m_dirModel_01->rowCount(),  pageSize * 2);
+
+    m_dirModel_01->fetchMore(QModelIndex());
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles - 1);
+    QCOMPARE(m_dirModel_01->canFetchMore(QModelIndex()),  false);
+
+    //rows keep the sort order across pages
+    for (int row = 0; row < createdFiles - 1; ++row) {
+        QModelIndex idx = m_dirModel_01->index(row, 0);
+        QCOMPARE(m_dirModel_01->data(idx, DirModel::FilePathRole).toString(),  created.at(row));
+    }
+}
+
+void TestDirModel::modelRefreshUnchangedDirectory()
+{
+    QString dirName("modelRefreshUnchangedDirectory");
+    m_deepDir_01 = new DeepDir(dirName,0);
+    TempFiles  tmpFiles;
+    const int createdFiles = 40;
+    tmpFiles.addSubDirLevel(dirName);
+    tmpFiles.create(createdFiles);
+
+    m_dirModel_01->setEnabledExternalFSWatcher(false);
+    m_dirModel_01->setPath(m_deepDir_01->path());
+    QTest::qWait(TIME_TO_REFRESH_DIR);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles);
+
+    QSignalSpy resetSpy(m_dirModel_01, SIGNAL(modelReset()));
+    QSignalSpy removedSpy(m_dirModel_01, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy insertedSpy(m_dirModel_01, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy changedSpy(m_dirModel_01, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+
+    m_dirModel_01->refresh();
+    QTest::qWait(TIME_TO_REFRESH_DIR);
+    QCOMPARE(m_dirModel_01->awaitingResults(),  false);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles);
+
+    //nothing changed on disk, so the model is not touched at all
+    QCOMPARE(resetSpy.count(),     0);
+    QCOMPARE(removedSpy.count(),   0);
+    QCOMPARE(insertedSpy.count(),  0);
+    QCOMPARE(changedSpy.count(),   0);
+}
+
+void TestDirModel::modelRefreshModifiedItem()
+{
+    QString dirName("modelRefreshModifiedItem");
+    m_deepDir_01 = new DeepDir(dirName,0);
+    TempFiles  tmpFiles;
+    const int createdFiles = 40;
+    const int modifiedRow  = 17;
+    tmpFiles.addSubDirLevel(dirName);
+    tmpFiles.create(createdFiles);
+
+    m_dirModel_01->setEnabledExternalFSWatcher(false);
+    m_dirModel_01->setPath(m_deepDir_01->path());
+    QTest::qWait(TIME_TO_REFRESH_DIR);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles);
+
+    QString modifiedFile = m_dirModel_01->data(m_dirModel_01->index(modifiedRow, 0),
+                                               DirModel::FilePathRole).toString();
+    QFile file(modifiedFile);
+    QCOMPARE(file.open(QFile::Append),  true);
+    QVERIFY(file.write("a line that changes the size\n") > 0);
+    file.close();
+
+    QSignalSpy resetSpy(m_dirModel_01, SIGNAL(modelReset()));
+    QSignalSpy removedSpy(m_dirModel_01, SIGNAL(rowsRemoved(QModelIndex,int,int)));
+    QSignalSpy insertedSpy(m_dirModel_01, SIGNAL(rowsInserted(QModelIndex,int,int)));
+    QSignalSpy changedSpy(m_dirModel_01, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)));
+
+    m_dirModel_01->refresh();
+    QTest::qWait(TIME_TO_REFRESH_DIR);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles);
+
+    //only the modified row is notified, it stays in its place
+    QCOMPARE(resetSpy.count(),     0);
+    QCOMPARE(removedSpy.count(),   0);
+    QCOMPARE(insertedSpy.count(),  0);
+    QCOMPARE(changedSpy.count(),   1);
+    QCOMPARE(changedSpy.at(0).at(0).toModelIndex().row(),  modifiedRow);
+    QCOMPARE(changedSpy.at(0).at(1).toModelIndex().row(),  modifiedRow);
+    QCOMPARE(m_dirModel_01->data(m_dirModel_01->index(modifiedRow, 0),
+                                 DirModel::FilePathRole).toString(),  modifiedFile);
+}
+
+void TestDirModel::modelExternalChangeMovesRow()
+{
+    QString dirName("modelExternalChangeMovesRow");
+    m_deepDir_01 = new DeepDir(dirName,0);
+    TempFiles  tmpFiles;
+    const int createdFiles = 20;
+    tmpFiles.addSubDirLevel(dirName);
+    //each file is bigger than the previous one
+    tmpFiles.create(createdFiles);
+
+    m_dirModel_01->setSortBy(DirModel::SortBySize);
+    m_dirModel_01->setSortOrder(DirModel::SortAscending);
+    m_dirModel_01->setPath(m_deepDir_01->path());
+    QTest::qWait(TIME_TO_REFRESH_DIR);
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles);
+
+    //the smallest file becomes the biggest one
+    QString smallest = m_dirModel_01->data(m_dirModel_01->index(0, 0),
+                                           DirModel::FilePathRole).toString();
+    QFile file(smallest);
+    QCOMPARE(file.open(QFile::Append),  true);
+    QCOMPARE(file.write(QByteArray(1024 * (createdFiles + 1), 'y')),  qint64(1024 * (createdFiles + 1)));
+    file.close();
+    QTest::qWait(EX_FS_WATCHER_TIMER_INTERVAL * 2);
+
+    QCOMPARE(m_dirModel_01->rowCount(),  createdFiles);
+    QCOMPARE(m_dirModel_01->data(m_dirModel_01->index(createdFiles - 1, 0),
+                                 DirModel::FilePathRole).toString(),  smallest);
+    //rows stay sorted by size
+    qint64 previousSize = -1;
+    for (int row = 0; row < createdFiles; ++row) {
+        QFileInfo info(m_dirModel_01->data(m_dirModel_01->index(row, 0),
+                                           DirModel::FilePathRole).toString());
+        QVERIFY(info.size() >= previousSize);
+        previousSize = info.size();
+    }
+}
+
+void TestDirModel::dirItemInfoStoreRoundTrip()
+{
+    QString dirName("dirItemInfoStoreRoundTrip");
+    m_deepDir_01 = new DeepDir(dirName,1);
+    TempFiles  tmpFiles;
+    const int createdFiles = 200;
+    tmpFiles.addSubDirLevel(dirName);
+    tmpFiles.create(createdFiles);
+
+    DirItemInfoList items;
+    QDirIterator it(m_deepDir_01->path(), QDir::AllEntries | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        DirItemInfo item(QFileInfo(it.next()));
+        item.resolveMimeTypeFromName();
+        items.append(item);
+    }
+    //the files and the sub directory
+    QCOMPARE(items.count(),  createdFiles + 1);
+
+    DirItemInfoStore store;
+    store.append(items);
+    store.squeeze();
+    QCOMPARE(store.count(),  items.count());
+
+    for (int counter = 0; counter < items.count(); ++counter) {
+        const DirItemInfo &item = items.at(counter);
+        const DirItemInfo  view = store.at(counter);
+        QCOMPARE(view.absoluteFilePath(),   item.absoluteFilePath());
+        QCOMPARE(view.fileName(),           item.fileName());
+        QCOMPARE(view.path(),               item.path());
+        QCOMPARE(view.size(),               item.size());
+        QCOMPARE(view.lastModified(),       item.lastModified());
+        QCOMPARE(view.isDir(),              item.isDir());
+        QCOMPARE(view.isFile(),             item.isFile());
+        QCOMPARE(view.isSymLink(),          item.isSymLink());
+        QCOMPARE(view.isWritable(),         item.isWritable());
+        QCOMPARE(view.permissions(),        item.permissions());
+        QCOMPARE(view.ownerId(),            item.ownerId());
+        QCOMPARE(view.groupId(),            item.groupId());
+        QCOMPARE(view.needsStat(),          item.needsStat());
+        QCOMPARE(view.mimeType().name(),    item.mimeType().name());
+    }
+
+    //columns and names only, about 60 bytes plus the name for each item
+    QVERIFY(store.memoryUsage() < qint64(items.count()) * 128);
+}
+
+/*!
+ * \brief TestDirModel::diskDirScannerMatchesQDirIterator()
+ *
+ *  \ref DiskDirScanner must return the same entries as QDirIterator for the filters DirModel uses,
+ *  with the same type, size, times and access of each entry, also when the stat is left for later.
+ */
+void TestDirModel::diskDirScannerMatchesQDirIterator()
+{
+    if (!DiskDirScanner::isAvailable())
+    {
+        QSKIP_ALL_TESTS("getdents64() is not available");
+    }
+    QString dirName("diskDirScannerMatchesQDirIterator");
+    m_deepDir_01 = new DeepDir(dirName,1);
+    TempFiles  tmpFiles;
+    tmpFiles.addSubDirLevel(dirName);
+    tmpFiles.create(3);
+    tmpFiles.create(QLatin1String(".hidden_file"), 1);
+    QString root = m_deepDir_01->path();
+
+    QCOMPARE(QDir(root).mkdir(QLatin1String(".hidden_dir")),  true);
+    QCOMPARE(QFile::link(tmpFiles.createdList().at(0), root + QLatin1String("/link_to_file")),   true);
+    QCOMPARE(QFile::link(m_deepDir_01->firstLevel(),  root + QLatin1String("/link_to_dir")),   true);
+    QCOMPARE(QFile::link(root + QLatin1String("/does_not_exist"), root + QLatin1String("/broken_link")), true);
+    //an executable file and a read only file
+    QCOMPARE(QFile::setPermissions(tmpFiles.createdList().at(1),
+                                   QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner | QFile::ExeGroup),  true);
+    QCOMPARE(QFile::setPermissions(tmpFiles.createdList().at(2), QFile::ReadOwner | QFile::ReadGroup),  true);
+
+    const QDir::Filters filters[] = {
+        QDir::AllEntries | QDir::NoDotAndDotDot,
+        QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden,
+        QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System,
+        QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System | QDir::NoSymLinks,
+        QDir::Files      | QDir::NoDotAndDotDot | QDir::Hidden,
+        QDir::AllDirs    | QDir::NoDotAndDotDot | QDir::Hidden
+    };
+
+    for (int lazy = 0; lazy < 2; ++lazy)
+    {
+        for (uint filter = 0; filter < sizeof(filters) / sizeof(filters[0]); ++filter)
+        {
+            QMap<QString, QFileInfo> expected;
+            QDirIterator it(root, filters[filter]);
+            while (it.hasNext())
+            {
+                it.next();
+                expected.insert(it.fileName(), it.fileInfo());
+            }
+
+            QMap<QString, DirItemInfo> scanned;
+            DiskDirScanner scanner(filters[filter]);
+            scanner.setLazyStat(lazy == 1);
+            QCOMPARE(scanner.open(root),  true);
+            DirItemInfo item;
+            while (scanner.next(item))
+            {
+                QCOMPARE(scanner.lastIsRealDir(),  item.isDir() && !item.isSymLink());
+                if (item.needsStat())
+                {
+                    //only regular files and directories are left without stat
+                    QCOMPARE(lazy,                         1);
+                    QCOMPARE(item.isSymLink(),             false);
+                    QCOMPARE(item.resolvePendingStat(),    true);
+                }
+                scanned.insert(item.fileName(), item);
+            }
+            QCOMPARE(scanned.keys(),   expected.keys());
+
+            foreach (const QString &name, expected.keys())
+            {
+                const QFileInfo   &fi = expected[name];
+                const DirItemInfo &di = scanned[name];
+                QCOMPARE(di.absoluteFilePath(),  fi.absoluteFilePath());
+                QCOMPARE(di.isSymLink(),         fi.isSymLink());
+                QCOMPARE(di.isReadable(),        fi.isReadable());
+                QCOMPARE(di.isWritable(),        fi.isWritable());
+                QCOMPARE(di.isExecutable(),      fi.isExecutable());
+                if (fi.exists())
+                {
+                    QCOMPARE(di.isDir(),         fi.isDir());
+                    QCOMPARE(di.isFile(),        fi.isFile());
+                    QCOMPARE(di.lastModified(),  fi.lastModified());
+                    QCOMPARE(di.permissions(),   fi.permissions());
+                    QCOMPARE(di.ownerId(),       fi.ownerId());
+                    QCOMPARE(di.groupId(),       fi.groupId());
+                    if (fi.isFile())
+                    {
+                        QCOMPARE(di.size(),      fi.size());
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * \brief TestDirModel::diskParallelScannerListsTree()
+ *
+ *  \ref DiskParallelScanner returns every item of a tree but the directories, links to directories
+ *  are listed as items and not entered; stopping a scan must not block.
+ */
+void TestDirModel::diskParallelScannerListsTree()
+{
+    QString dirName("diskParallelScannerListsTree");
+    m_deepDir_01 = new DeepDir(dirName,5);
+    QString root = m_deepDir_01->path();
+    //a link to an ancestor would make a scan that follows links endless
+    QCOMPARE(QFile::link(root, m_deepDir_01->lastLevel() + QLatin1String("/link_to_root")),  true);
+
+    const QDir::Filters filter = QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden;
+    QStringList expected;
+    QDirIterator it(root, filter, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        if (!it.fileInfo().isDir() || it.fileInfo().isSymLink())
+        {
+            expected.append(it.filePath());
+        }
+    }
+    expected.sort();
+    QCOMPARE(expected.count(),  m_deepDir_01->filesCreated() + 1);
+
+    //the native scanner and the QDirIterator fallback
+    for (int native = 0; native < 2; ++native)
+    {
+        DiskParallelScanner scanner(filter, native == 1, 4);
+        scanner.start(root);
+        QStringList found;
+        DirItemInfoList results;
+        while (scanner.takeResults(results))
+        {
+            foreach (const DirItemInfo &item, results)
+            {
+                found.append(item.absoluteFilePath());
+            }
+        }
+        found.sort();
+        QCOMPARE(found,  expected);
+    }
+
+    //results published before stop() can still be taken, then it ends
+    DiskParallelScanner cancelled(filter, true, 4);
+    cancelled.start(root);
+    cancelled.stop();
+    int counter = 0;
+    DirItemInfoList results;
+    while (cancelled.takeResults(results))
+    {
+        counter += results.count();
+    }
+    QVERIFY(counter <= expected.count());
+}
+
+/*!
+ * \brief TestDirModel::dirListingSnapshotRoundTrip()
+ *
+ *  Items read from a \ref DirListingSnapshot must be equal to the items saved, a snapshot of another
+ *  directory, of an older directory modification time, truncated or of another version is rejected.
+ */
+void TestDirModel::dirListingSnapshotRoundTrip()
+{
+    QString dirName("dirListingSnapshotRoundTrip");
+    m_deepDir_01 = new DeepDir(dirName,1);
+    TempFiles  tmpFiles;
+    const int createdFiles = 20;
+    tmpFiles.addSubDirLevel(dirName);
+    tmpFiles.create(createdFiles);
+    QString root = m_deepDir_01->path();
+    QCOMPARE(QFile::link(tmpFiles.createdList().at(0), root + QLatin1String("/link_to_file")),   true);
+    QCOMPARE(QFile::setPermissions(tmpFiles.createdList().at(1),
+                                   QFile::ReadOwner | QFile::WriteOwner | QFile::ExeOwner),  true);
+
+    DirItemInfoList items;
+    QDirIterator it(root, QDir::AllEntries | QDir::NoDotAndDotDot);
+    while (it.hasNext())
+    {
+        DirItemInfo item(QFileInfo(it.next()));
+        item.resolveMimeTypeFromName();
+        items.append(item);
+    }
+    //the files, the sub directory and the link
+    QCOMPARE(items.count(),  createdFiles + 2);
+
+    QTemporaryDir snapshotsDir;
+    QCOMPARE(snapshotsDir.isValid(),  true);
+    const QString   fileName    = snapshotsDir.path() + QLatin1String("/listing");
+    const QDateTime dirModified = QFileInfo(root).lastModified();
+    QCOMPARE(DirListingSnapshot::write(fileName, root, dirModified, items),  true);
+
+    DirItemInfoList snapshot;
+    QCOMPARE(DirListingSnapshot::read(fileName, root, dirModified, snapshot),  true);
+    QCOMPARE(snapshot.count(),  items.count());
+    for (int counter = 0; counter < items.count(); ++counter)
+    {
+        const DirItemInfo &item = items.at(counter);
+        const DirItemInfo &read = snapshot.at(counter);
+        QCOMPARE(read.absoluteFilePath(),   item.absoluteFilePath());
+        QCOMPARE(read.size(),               item.size());
+        QCOMPARE(read.lastModified(),       item.lastModified());
+        QCOMPARE(read.created(),            item.created());
+        QCOMPARE(read.lastRead(),           item.lastRead());
+        QCOMPARE(read.isDir(),              item.isDir());
+        QCOMPARE(read.isSymLink(),          item.isSymLink());
+        QCOMPARE(read.isReadable(),         item.isReadable());
+        QCOMPARE(read.isWritable(),         item.isWritable());
+        QCOMPARE(read.isExecutable(),       item.isExecutable());
+        QCOMPARE(read.permissions(),        item.permissions());
+        QCOMPARE(read.ownerId(),            item.ownerId());
+        QCOMPARE(read.groupId(),            item.groupId());
+        QCOMPARE(read.mimeType().name(),    item.mimeType().name());
+    }
+
+    //another directory or a directory changed since the snapshot was taken
+    QCOMPARE(DirListingSnapshot::read(fileName, root + QLatin1String("/other"), dirModified, snapshot), false);
+    QCOMPARE(DirListingSnapshot::read(fileName, root, dirModified.addSecs(1), snapshot),  false);
+
+    //a truncated file
+    const QString damaged = snapshotsDir.path() + QLatin1String("/damaged");
+    QCOMPARE(QFile::copy(fileName, damaged),  true);
+    QCOMPARE(QFile::resize(damaged, QFileInfo(fileName).size() - 1),  true);
+    QCOMPARE(DirListingSnapshot::read(damaged, root, dirModified, snapshot),  false);
+
+    //another version, it is the second field of the header
+    QFile::remove(damaged);
+    QCOMPARE(QFile::copy(fileName, damaged),  true);
+    QFile file(damaged);
+    QCOMPARE(file.open(QFile::ReadWrite),  true);
+    const quint32 version = DIRLIST_SNAPSHOT_VERSION + 1;
+    QCOMPARE(file.seek(sizeof(quint32)),  true);
+    QCOMPARE(file.write(reinterpret_cast<const char*>(&version), sizeof(version)),  qint64(sizeof(version)));
+    file.close();
+    QCOMPARE(DirListingSnapshot::read(damaged, root, dirModified, snapshot),  false);
+}
+
+/*!
+ * \brief TestDirModel::nameFilterMatcherAgainstQRegExp()
+ *
+ *  \ref NameFilterMatcher must give the same result as QRegExp wildcards for each kind of pattern
+ *  it compiles apart: suffixes, exact names, prefixes and the others joined in a regular expression.
+ */
+void TestDirModel::nameFilterMatcherAgainstQRegExp()
+{
+    const QStringList patterns = QStringList()
+            << QLatin1String("*.txt")     << QLatin1String("*.TAR.GZ")   << QLatin1String("read*")
+            << QLatin1String("exact_name") << QLatin1String("file?.log") << QLatin1String("[abc]*.c")
+            << QLatin1String("[^a]?.txt") << QLatin1String("*[0-9].dat") << QLatin1String("data.[ch]")
+            << QLatin1String("[]x]y");
+    const QStringList names = QStringList()
+            << QLatin1String("a.txt")        << QLatin1String("A.TXT")        << QLatin1String(".txt")
+            << QLatin1String("txt")          << QLatin1String("a.txt.bak")    << QLatin1String("archive.tar.gz")
+            << QLatin1String("x.gz")         << QLatin1String("README")       << QLatin1String("readme.md")
+            << QLatin1String("already")      << QLatin1String("exact_name")   << QLatin1String("Exact_Name")
+            << QLatin1String("exact_name2")  << QLatin1String("file1.log")    << QLatin1String("file12.log")
+            << QLatin1String("file.log")     << QLatin1String("a.c")          << QLatin1String("B1.c")
+            << QLatin1String("d.c")          << QLatin1String("ab.txt")       << QLatin1String("bb.txt")
+            << QLatin1String("x9.dat")       << QLatin1String("x.dat")        << QLatin1String("data.c")
+            << QLatin1String("data.H")       << QLatin1String("data.o")       << QLatin1String("]y")
+            << QLatin1String("xy")           << QLatin1String("zy")           << QString();
+
+    //each pattern alone
+    foreach (const QString &pattern, patterns)
+    {
+        NameFilterMatcher matcher(QStringList() << pattern);
+        QRegExp           wildcard(pattern, Qt::CaseInsensitive, QRegExp::Wildcard);
+        foreach (const QString &name, names)
+        {
+            QVERIFY2(matcher.matches(name) == wildcard.exactMatch(name),
+                     qPrintable(pattern + QLatin1String(" x ") + name));
+        }
+    }
+
+    //all patterns together, a name matches when any of them matches
+    NameFilterMatcher matcher(patterns);
+    foreach (const QString &name, names)
+    {
+        bool expected = false;
+        foreach (const QString &pattern, patterns)
+        {
+            expected = expected || QRegExp(pattern, Qt::CaseInsensitive, QRegExp::Wildcard).exactMatch(name);
+        }
+        QVERIFY2(matcher.matches(name) == expected,  qPrintable(name));
+    }
+
+    QCOMPARE(NameFilterMatcher(QStringList() << QLatin1String("*")).matchesAll(),  true);
+    QCOMPARE(NameFilterMatcher(QStringList()).matches(QLatin1String("a.txt")),   false);
+}
+
 void TestDirModel::trashDiretories()
 {
     QTrashDir  trash;